@@ -0,0 +1,81 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "bloom_filter.h"
+#include "cuckoo_filter.h"
+
+using namespace std;
+
+// 布谷鸟过滤器与布隆过滤器对比（需要hiredis和本地redis-server）：
+//  1. 不同目标误判率下每个元素占用的位数和实测误判率
+//  2. 黑名单删除1%的元素后：布谷鸟过滤器remove + 增量save，布隆过滤器只能整体重建
+
+vector<string> make_keys(const string& prefix, size_t count)
+{
+    vector<string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i) keys.push_back(prefix + to_string(i) + "@example.com");
+    return keys;
+}
+
+double elapsed_ms(chrono::steady_clock::time_point begin)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+}
+
+int main(int argc, char* argv[])
+{
+    const string host = "127.0.0.1";
+    const int port = 6379;
+    const string password = "123456";
+    size_t items = argc > 1 ? stoull(argv[1]) : 1000000;
+
+    try {
+        vector<string> members = make_keys("member", items);
+        vector<string> others = make_keys("other", 1000000);
+
+        cout << "target, cuckoo bits/item, cuckoo fp, bloom bits/item, bloom fp\n";
+        for (double target : { 0.01, 0.001, 0.0001 }) {
+            CuckooFilter cuckoo(host, port, "bench_cuckoo", password, items, target);
+            for (const string& key : members) cuckoo.add(key);
+            size_t cuckoo_fp = 0;
+            for (const string& key : others) cuckoo_fp += cuckoo.contains(key);
+
+            // 每个误判率用单独的键，位图大小不同，不能共用
+            BloomFilter bloom(host, port, "bench_cuckoo_bloom:" + to_string(target), password, items, target);
+            bloom.add_many(members);
+            size_t bloom_fp = 0;
+            for (bool found : bloom.contains_many(others)) bloom_fp += found;
+
+            cout << target << ", " << cuckoo.bits_per_item() << ", " << static_cast<double>(cuckoo_fp) / others.size() << ", "
+                 << static_cast<double>(bloom.bitmap_bits()) / items << ", " << static_cast<double>(bloom_fp) / others.size() << "\n";
+        }
+
+        CuckooFilter cuckoo(host, port, "bench_cuckoo", password, items, 0.001);
+        for (const string& key : members) cuckoo.add(key);
+        auto begin = chrono::steady_clock::now();
+        cuckoo.save();
+        cout << "\ncuckoo full save: " << elapsed_ms(begin) << " ms\n";
+
+        vector<string> removed(members.begin(), members.begin() + items / 100);
+        begin = chrono::steady_clock::now();
+        for (const string& key : removed) cuckoo.remove(key);
+        cuckoo.save();
+        cout << "cuckoo remove " << removed.size() << " + incremental save: " << elapsed_ms(begin) << " ms\n";
+
+        // 每晚重建时写入一个新的位图
+        BloomFilter rebuilt(host, port, "bench_cuckoo_rebuild", password, items, 0.001);
+        vector<string> remaining(members.begin() + items / 100, members.end());
+        begin = chrono::steady_clock::now();
+        rebuilt.add_many(remaining);
+        cout << "bloom rebuild with " << remaining.size() << " items: " << elapsed_ms(begin) << " ms\n\n";
+
+        cuckoo.print_stats();
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "murmur3.h"
+
+using namespace std;
+
+// 计算k个位位置的开销对比（不访问Redis）：
+//  fnv_k        - 原来的做法，k个std::function闭包，每个对字符串完整跑一遍带种子的FNV-1a
+//  murmur_dh    - MurmurHash3 x64_128只算一次，k个位置由双重哈希推出，k在运行时确定
+//  murmur_dh_K  - 同上，k是编译期常量，循环可以完全展开
+
+const size_t ELEMENTS = 100000;
+const size_t EXPECTED = 100000;
+const double FP_RATE = 0.01;
+
+// 随机的邮箱地址，长度与main.cpp中生成的相近（约15~25字节）
+vector<string> generate_emails(size_t count)
+{
+    const vector<string> domains = {"gmail.com", "yahoo.com", "hotmail.com", "outlook.com", "protonmail.com"};
+    mt19937 gen(42);
+    uniform_int_distribution<> domain_dist(0, domains.size() - 1);
+    uniform_int_distribution<> num_dist(1000, 9999999);
+
+    vector<string> emails;
+    emails.reserve(count);
+    for (size_t i = 0; i < count; ++i) emails.push_back(to_string(num_dist(gen)) + "@" + domains[domain_dist(gen)]);
+    return emails;
+}
+
+vector<function<size_t(const string&)>> make_fnv_functions(size_t k)
+{
+    vector<function<size_t(const string&)>> functions;
+    for (size_t i = 0; i < k; ++i) {
+        functions.emplace_back([seed = i](const string& str) -> size_t {
+            const size_t prime = 0x100000001b3;
+            size_t hash = 0xcbf29ce484222325 ^ seed;
+            for (char c : str) {
+                hash ^= static_cast<size_t>(c);
+                hash *= prime;
+            }
+            return hash;
+        });
+    }
+    return functions;
+}
+
+template<size_t K>
+void positions_fixed(const string& element, size_t m, size_t* positions)
+{
+    Hash128 hash = murmur3_x64_128(element.data(), element.size());
+    for (size_t i = 0; i < K; ++i) positions[i] = (hash.h1 + i * hash.h2) % m;
+}
+
+template<typename F>
+double measure(const vector<string>& emails, size_t& checksum, F&& positions_of)
+{
+    const int ROUNDS = 20;
+    size_t positions[32];
+    auto begin = chrono::steady_clock::now();
+    for (int r = 0; r < ROUNDS; ++r) {
+        for (const string& email : emails) {
+            positions_of(email, positions);
+            checksum += positions[0];
+        }
+    }
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / (ROUNDS * emails.size());
+}
+
+int main()
+{
+    size_t m = static_cast<size_t>(-(EXPECTED * log(FP_RATE)) / (log(2) * log(2)));
+    size_t k = static_cast<size_t>(ceil((m / static_cast<double>(EXPECTED)) * log(2)));
+    if (k != 7) {
+        cerr << "expected k = 7 for p = 1%, got " << k << endl;
+        return 1;
+    }
+
+    vector<string> emails = generate_emails(ELEMENTS);
+    auto fnv = make_fnv_functions(k);
+    size_t checksum = 0;
+
+    double fnv_ns = measure(emails, checksum, [&](const string& e, size_t* positions) {
+        for (size_t i = 0; i < k; ++i) positions[i] = fnv[i](e) % m;
+    });
+    double dh_ns = measure(emails, checksum, [&](const string& e, size_t* positions) {
+        Hash128 hash = murmur3_x64_128(e.data(), e.size());
+        for (size_t i = 0; i < k; ++i) positions[i] = (hash.h1 + i * hash.h2) % m;
+    });
+    double fixed_ns = measure(emails, checksum, [&](const string& e, size_t* positions) {
+        positions_fixed<7>(e, m, positions);
+    });
+
+    cout << "k = " << k << ", m = " << m << " bits, " << ELEMENTS << " emails\n";
+    cout << "variant, ns/element, speedup\n";
+    cout << "fnv_k, " << fnv_ns << ", 1\n";
+    cout << "murmur_dh, " << dh_ns << ", " << fnv_ns / dh_ns << "\n";
+    cout << "murmur_dh_K, " << fixed_ns << ", " << fnv_ns / fixed_ns << "\n";
+    cout << "(checksum " << checksum << ")\n";
+    return 0;
+}
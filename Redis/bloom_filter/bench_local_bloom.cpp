@@ -0,0 +1,111 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "local_bloom_filter.h"
+
+using namespace std;
+
+// 本地布隆过滤器的查询开销（不访问Redis），误判率1%：
+//  standard       - 普通位图，k个位分散在整个位图中，每次查询最多k次缓存未命中
+//  blocked_scalar - 分块布局，k个位在同一个64字节块中，逐个lane检查
+//  blocked_avx2   - 分块布局，AVX2一次算出16个lane的掩码并比较
+// 过滤器远大于CPU缓存时，差距主要来自缓存未命中的次数。
+
+// 与BloomFilter的Standard布局相同的本地位图
+class StandardBitmap {
+public:
+    StandardBitmap(size_t n, double p)
+    {
+        m_bits = static_cast<size_t>(-(n * log(p)) / (log(2) * log(2)));
+        m_k = static_cast<size_t>(ceil(m_bits / static_cast<double>(n) * log(2)));
+        m_words.assign((m_bits + 63) / 64, 0);
+    }
+
+    void add(const string& element)
+    {
+        Hash128 hash = murmur3_x64_128(element.data(), element.size());
+        for (size_t i = 0; i < m_k; ++i) {
+            size_t pos = (hash.h1 + i * hash.h2) % m_bits;
+            m_words[pos / 64] |= uint64_t(1) << (pos % 64);
+        }
+    }
+
+    bool contains(const string& element) const
+    {
+        Hash128 hash = murmur3_x64_128(element.data(), element.size());
+        for (size_t i = 0; i < m_k; ++i) {
+            size_t pos = (hash.h1 + i * hash.h2) % m_bits;
+            if ((m_words[pos / 64] & (uint64_t(1) << (pos % 64))) == 0) return false;
+        }
+        return true;
+    }
+
+private:
+    size_t m_bits;
+    size_t m_k;
+    vector<uint64_t> m_words;
+};
+
+vector<string> make_keys(const string& prefix, size_t count, uint64_t seed)
+{
+    mt19937_64 gen(seed);
+    vector<string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i) keys.push_back(prefix + to_string(gen() % 10000000000ULL) + "@example.com");
+    return keys;
+}
+
+template<typename Filter>
+void run(const string& name, const Filter& filter, const vector<string>& members, const vector<string>& others)
+{
+    size_t found = 0;
+    auto begin = chrono::steady_clock::now();
+    for (const string& key : members) found += filter.contains(key);
+    double hit_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / members.size();
+
+    size_t false_positives = 0;
+    begin = chrono::steady_clock::now();
+    for (const string& key : others) false_positives += filter.contains(key);
+    double miss_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / others.size();
+
+    cout << name << ", " << hit_ns << ", " << miss_ns << ", "
+         << static_cast<double>(false_positives) / others.size() << (found == members.size() ? "" : " (false negative!)") << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+    size_t items = argc > 1 ? stoull(argv[1]) : 10000000;
+    const size_t QUERIES = 2000000;
+    const double FP_RATE = 0.01;
+
+    vector<string> members = make_keys("m", items, 1);
+    vector<string> others = make_keys("x", QUERIES, 2);
+
+    // 查询已存在元素时在其中随机抽样，访问模式不受插入顺序影响
+    vector<string> member_queries;
+    mt19937_64 gen(3);
+    for (size_t i = 0; i < QUERIES; ++i) member_queries.push_back(members[gen() % members.size()]);
+
+    StandardBitmap standard(items, FP_RATE);
+    LocalBloomFilter blocked(items, FP_RATE);
+    for (const string& key : members) {
+        standard.add(key);
+        blocked.add(key);
+    }
+
+    cout << items << " items, bitmap " << blocked.bitmap_bytes() / (1024.0 * 1024.0) << " MB, k = "
+         << blocked.num_hashes() << ", AVX2 " << (blocked.simd() ? "available" : "unavailable") << "\n";
+    cout << "variant, ns/lookup (member), ns/lookup (non-member), false positive rate\n";
+    run("standard", standard, member_queries, others);
+
+    blocked.use_simd(false);
+    run("blocked_scalar", blocked, member_queries, others);
+
+    blocked.use_simd(true);
+    if (blocked.simd()) run("blocked_avx2", blocked, member_queries, others);
+    return 0;
+}
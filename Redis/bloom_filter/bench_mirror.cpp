@@ -0,0 +1,64 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bloom_filter.h"
+
+using namespace std;
+
+// 本地镜像前后searchKey的延迟对比（需要hiredis和本地redis-server）：
+//  redis  - 每次查询一条BITFIELD，一次网络往返
+//  mirror - enable_mirror之后只查本地位图
+// 最后用另一个BloomFilter写入一个新元素，测量镜像多久能看到它。
+
+double lookup_ns(BloomFilter& filter, const vector<string>& keys)
+{
+    size_t found = 0;
+    auto begin = chrono::steady_clock::now();
+    for (const string& key : keys) found += filter.searchKey(key);
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / keys.size();
+    if (found != keys.size()) cout << "  (false negative!)\n";
+    return ns;
+}
+
+int main(int argc, char* argv[])
+{
+    const string host = "127.0.0.1";
+    const int port = 6379;
+    const string password = "123456";
+    size_t items = argc > 1 ? stoull(argv[1]) : 1000000;
+
+    try {
+        BloomFilter writer(host, port, "bench_mirror", password, items, 0.01, BloomLayout::Blocked);
+        BloomFilter reader(host, port, "bench_mirror", password, items, 0.01, BloomLayout::Blocked);
+        // 读取方开启了镜像，写入方要发布自己的添加
+        writer.publish_adds(true);
+
+        vector<string> keys;
+        keys.reserve(items);
+        for (size_t i = 0; i < items; ++i) keys.push_back("user" + to_string(i) + "@example.com");
+        writer.add_many(keys);
+
+        vector<string> queries(keys.begin(), keys.begin() + min<size_t>(keys.size(), 20000));
+        cout << "redis,  ns/lookup: " << lookup_ns(reader, queries) << "\n";
+
+        auto begin = chrono::steady_clock::now();
+        reader.enable_mirror();
+        cout << "mirror loaded in " << chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count() << " ms\n";
+        cout << "mirror, ns/lookup: " << lookup_ns(reader, keys) << "\n";
+
+        begin = chrono::steady_clock::now();
+        writer.add("late@example.com");
+        while (!reader.searchKey("late@example.com")) this_thread::yield();
+        cout << "add visible in mirror after " << chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count() << " us\n";
+
+        reader.print_stats();
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "scalable_bloom_filter.h"
+
+using namespace std;
+
+// 写入远超预期数量的元素后，普通布隆过滤器与可扩展布隆过滤器的误判率对比（需要hiredis和本地redis-server）。
+// 两者都按10000个元素、1%误判率建立，写入数量由命令行指定（默认20万）。
+
+int main(int argc, char* argv[])
+{
+    const string host = "127.0.0.1";
+    const int port = 6379;
+    const string password = "123456";
+    const size_t expected = 10000;
+    const size_t QUERIES = 100000;
+    size_t items = argc > 1 ? stoull(argv[1]) : 200000;
+
+    try {
+        BloomFilter plain(host, port, "bench_plain", password, expected, 0.01);
+        ScalableBloomFilter scalable(host, port, "bench_scalable", password, expected, 0.01);
+        scalable.clear();
+
+        vector<string> keys;
+        keys.reserve(items);
+        for (size_t i = 0; i < items; ++i) keys.push_back("user" + to_string(i) + "@example.com");
+        plain.add_many(keys);
+        for (const string& key : keys) scalable.add(key);
+
+        size_t plain_fp = 0;
+        size_t scalable_fp = 0;
+        vector<string> others;
+        others.reserve(QUERIES);
+        for (size_t i = 0; i < QUERIES; ++i) others.push_back("other" + to_string(i) + "@example.com");
+        for (bool found : plain.contains_many(others)) plain_fp += found;
+        for (const string& key : others) scalable_fp += scalable.contains(key);
+
+        cout << items << " items into filters sized for " << expected << "\n";
+        cout << "plain,    false positive rate: " << static_cast<double>(plain_fp) / QUERIES << "\n";
+        cout << "scalable, false positive rate: " << static_cast<double>(scalable_fp) / QUERIES << "\n";
+        scalable.print_stats();
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "sharded_bloom_filter.h"
+
+using namespace std;
+
+// 分片布隆过滤器（需要hiredis和redis-server）：批量写入和查询的吞吐、实测误判率，以及分片在各节点上的分布。
+// 用法：bench_sharded [元素数] [端口...]，默认100万元素、127.0.0.1:6379一个节点；
+// 给出多个端口时分片轮流放在这些节点上。分片大小取64KB，让元素分散到多个键上。
+
+double elapsed_ms(chrono::steady_clock::time_point begin)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+}
+
+int main(int argc, char* argv[])
+{
+    const string host = "127.0.0.1";
+    const string password = "123456";
+    const size_t QUERIES = 1000000;
+    size_t items = argc > 1 ? stoull(argv[1]) : 1000000;
+
+    vector<RedisNode> nodes;
+    for (int i = 2; i < argc; ++i) nodes.push_back({ host, stoi(argv[i]), password });
+    if (nodes.empty()) nodes.push_back({ host, 6379, password });
+
+    try {
+        ShardedBloomFilter filter(nodes, "bench_sharded", items, 0.01, 64 << 10);
+        filter.clear();
+
+        vector<string> members;
+        members.reserve(items);
+        for (size_t i = 0; i < items; ++i) members.push_back("user" + to_string(i) + "@example.com");
+        vector<string> others;
+        others.reserve(QUERIES);
+        for (size_t i = 0; i < QUERIES; ++i) others.push_back("other" + to_string(i) + "@example.com");
+
+        auto begin = chrono::steady_clock::now();
+        filter.add_many(members);
+        double add_ms = elapsed_ms(begin);
+
+        begin = chrono::steady_clock::now();
+        size_t missing = 0;
+        for (bool found : filter.contains_many(members)) missing += !found;
+        double hit_ms = elapsed_ms(begin);
+
+        begin = chrono::steady_clock::now();
+        size_t fp = 0;
+        for (bool found : filter.contains_many(others)) fp += found;
+        double miss_ms = elapsed_ms(begin);
+
+        cout << items << " items, " << filter.num_shards() << " shards on " << nodes.size() << " node(s)\n";
+        cout << "add_many:             " << add_ms << " ms (" << items / add_ms * 1000 << " /s)\n";
+        cout << "contains_many (hit):  " << hit_ms << " ms, false negatives " << missing << "\n";
+        cout << "contains_many (miss): " << miss_ms << " ms, false positive rate " << static_cast<double>(fp) / QUERIES << "\n";
+        filter.print_stats();
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
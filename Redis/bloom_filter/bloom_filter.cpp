@@ -1,5 +1,9 @@
 ﻿#include "bloom_filter.h"
 
+#include <algorithm>
+#include <stdexcept>
+#include <sys/socket.h>
+
 using namespace std;
 
 /**
@@ -11,26 +15,42 @@ using namespace std;
 * @param key Redis 中存储位图的键名
 * @param expected_items 预期存储的元素数量
 * @param m_false_positive_rate 可接受的误判率 (0.01 表示 1%)
+* @param layout 位图布局，Blocked可以与LocalBloomFilter互相导入导出
 */
 BloomFilter::BloomFilter(const std::string& redis_host, int redis_port,
 	const std::string& key,
     const std::string& password,
 	size_t expected_items,
-	double m_false_positive_rate) :m_redis_password(password), m_redis_key(key), m_redis_conn(nullptr)
+	double m_false_positive_rate,
+	BloomLayout layout) :m_redis_password(password), m_redis_key(key), m_redis_conn(nullptr), m_layout(layout),
+	m_redis_host(redis_host), m_redis_port(redis_port)
 {
 	//连接redis
     connect_redis(redis_host, redis_port);
 
     // 计算最优参数
 	calculate_optimal_parameters(expected_items, m_false_positive_rate);
+}
 
-    // 初始化哈希函数
-	initialize_hash_functions();
+/**
+* @brief 借用连接的构造函数
+*
+* @param conn 调用方的连接，生命周期由调用方管理
+*/
+BloomFilter::BloomFilter(redisContext* conn,
+	const std::string& key,
+	size_t expected_items,
+	double m_false_positive_rate,
+	BloomLayout layout) :m_redis_conn(conn), m_redis_key(key), m_layout(layout),
+	m_redis_port(0), m_owns_conn(false)
+{
+	calculate_optimal_parameters(expected_items, m_false_positive_rate);
 }
 
 BloomFilter::~BloomFilter()
 {
-	if (m_redis_conn) {
+	stop_mirror();
+	if (m_redis_conn && m_owns_conn) {
 		redisFree(m_redis_conn);
 	}
 }
@@ -71,62 +91,707 @@ void BloomFilter::connect_redis(const string& redis_host, int redis_port)
     //认证密码，如果有密码的话，需要先认证一下，没有密码那就注释掉这行代码。
 	redisReply *reply = reinterpret_cast<redisReply*>(redisCommand(
 		m_redis_conn, "AUTH %s", m_redis_password.c_str()));    
-	if (reply->type == REDIS_REPLY_ERROR) {
+	if (reply == nullptr || reply->type == REDIS_REPLY_ERROR) {
         cerr<<"Redis认证失败！\n";
+        if (reply) freeReplyObject(reply);
         redisFree(m_redis_conn);
         exit(1);
     }
     else{
         cout<<"Redis认证成功！\n";
     }
+    freeReplyObject(reply);
 }
 
 /**
  * @brief 向布隆过滤器中添加元素
  *
+ * k个位在一条BITFIELD命令中一起设置，只需要一次往返；BITFIELD SET返回各个位原来的值
+ *
  * @param element 要添加的元素
+ * @return true 至少有一位原来为0，元素是新加入的
+ * @return false 所有位原来都为1（元素可能已经存在），或Redis出错
  */
-void BloomFilter::add(const string& element) 
+bool BloomFilter::add(const string& element) 
 {
-	for (size_t i = 0; i < m_num_hashes; ++i) {
-		size_t bit_position = calculate_bit_position(element, i);
-		redisCommand(m_redis_conn, "SETBIT %s %d 1", m_redis_key.c_str(), static_cast<int>(bit_position));
+	redisReply* reply = bitfield(element, true);
+	if (reply == nullptr) {
+		std::cerr << "Redis command failed" << std::endl;
+		return false;
+	}
+
+	bool added = false;
+	for (size_t i = 0; i < reply->elements; ++i) {
+		if (reply->element[i]->integer == 0) {
+			added = true;
+			break;
+		}
 	}
+	freeReplyObject(reply);
+
+	if (m_mirrored) mirror_add(element);
+	return added;
 }
 
 /**
  * @brief 检查元素是否可能存在于布隆过滤器中
  *
+ * k个位在一条BITFIELD命令中一起读取，只需要一次往返；开启本地镜像后只查本地
+ *
  * @param element 要检查的元素
  * @return true 元素可能存在（可能有误判）
  * @return false 元素绝对不存在
  */
 bool BloomFilter::searchKey(const std::string& element)
 {
-	for (size_t i = 0; i < m_num_hashes; ++i) {
-		size_t bit_position = calculate_bit_position(element, i);
+	if (m_mirrored) return mirror_contains(element);
 
-		redisReply* reply = static_cast<redisReply*>(
-			redisCommand(m_redis_conn, "GETBIT %s %d", m_redis_key.c_str(), static_cast<int>(bit_position)));
+	redisReply* reply = bitfield(element, false);
+	if (reply == nullptr) {
+		// 无法确认元素不存在，按可能存在处理
+		std::cerr << "Redis command failed" << std::endl;
+		return true;
+	}
+
+	bool found = true;
+	for (size_t i = 0; i < reply->elements; ++i) {
+		// 如果任何一个位为0，则元素一定不存在
+		if (reply->element[i]->integer == 0) {
+			found = false;
+			break;
+		}
+	}
 
+	freeReplyObject(reply);
+	return found;
+}
+
+/**
+ * @brief 批量添加元素
+ *
+ * 所有命令以流水线方式发送，最多window条回复未读取，避免输出缓冲和Redis端的回复积压无限增长。
+ * 整批的耗时取决于带宽，而不是元素个数乘以往返时间。
+ *
+ * @param elements 要添加的元素
+ * @param window 同时在途的命令数上限
+ */
+void BloomFilter::add_many(const std::vector<std::string>& elements, size_t window)
+{
+	pipeline(elements, true, window, [&](size_t index, redisReply*) {
+		if (m_mirrored) mirror_add(elements[index]);
+	});
+}
+
+/**
+ * @brief 批量检查元素是否可能存在
+ *
+ * @param elements 要检查的元素
+ * @param window 同时在途的命令数上限
+ * @return 与elements一一对应，true 可能存在，false 一定不存在；出错时未得到回复的元素按可能存在处理
+ */
+std::vector<bool> BloomFilter::contains_many(const std::vector<std::string>& elements, size_t window)
+{
+	vector<bool> result(elements.size(), true);
+	if (m_mirrored) {
+		for (size_t i = 0; i < elements.size(); ++i) result[i] = mirror_contains(elements[i]);
+		return result;
+	}
+
+	pipeline(elements, false, window, [&](size_t index, redisReply* reply) {
+		for (size_t i = 0; i < reply->elements; ++i) {
+			if (reply->element[i]->integer == 0) {
+				result[index] = false;
+				break;
+			}
+		}
+	});
+	return result;
+}
+
+/**
+ * @brief 以流水线方式为每个元素发送一条BITFIELD命令
+ *
+ * 先追加命令，在途命令达到window条时读取最早的一条回复。hiredis在读取回复前会把缓冲中的命令全部写出，
+ * 所以每次读取之前已经有一整批命令在路上。
+ *
+ * Redis对某条命令返回错误时跳过这个元素（不调用on_reply，查询时按可能存在处理），继续读取后面的回复，
+ * 连接上不会留下未读的回复。只有连接本身出错时才停止，并丢弃连接。
+ *
+ * @param on_reply 按元素顺序对每条成功的回复调用 on_reply(下标, 回复)
+ * @return 全部成功返回true；有元素出错或连接出错时返回false
+ */
+bool BloomFilter::pipeline(const std::vector<std::string>& elements, bool set, size_t window,
+	const std::function<void(size_t, redisReply*)>& on_reply)
+{
+	if (elements.empty()) return true;
+	if (!ensure_connection()) return false;
+	if (window == 0) window = 1;
+	size_t sent = 0;
+	size_t received = 0;
+	size_t failed = 0;
+
+	while (received < elements.size()) {
+		if (sent < elements.size() && sent - received < window) {
+			if (!append_bitfield(elements[sent], set)) {
+				drop_connection();
+				break;
+			}
+			++sent;
+			continue;
+		}
+
+		redisReply* reply = nullptr;
+		if (!read_bitfield_reply(set, reply)) break;
 		if (reply == nullptr) {
-			std::cerr << "Redis command failed" << std::endl;
+			++failed;
+			++received;
 			continue;
 		}
+		on_reply(received++, reply);
+		freeReplyObject(reply);
+	}
 
-		// 如果任何一个位为0，则元素一定不存在
-		if (reply->integer == 0) {
+	if (received < elements.size()) {
+		std::cerr << "Redis pipeline failed after " << received << " of " << elements.size() << " elements" << std::endl;
+		return false;
+	}
+	if (failed > 0) {
+		std::cerr << "Redis pipeline: " << failed << " of " << elements.size() << " commands returned an error" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief 对元素的k个位执行一条BITFIELD命令
+ *
+ * @param element 元素
+ * @param set true 设置为1，false 读取
+ * @return 回复（调用方负责释放），出错时返回nullptr；读取时为k个整数组成的数组
+ */
+redisReply* BloomFilter::bitfield(const std::string& element, bool set)
+{
+	redisReply* reply = nullptr;
+	if (!ensure_connection()) {
+		// 借用的连接已断开
+	} else if (!append_bitfield(element, set)) {
+		drop_connection();
+	} else {
+		read_bitfield_reply(set, reply);
+	}
+
+	if (reply == nullptr && !m_owns_conn) throw runtime_error("BITFIELD failed on " + m_redis_key);
+	return reply;
+}
+
+/**
+ * @brief 把元素的BITFIELD命令追加到输出缓冲，不等待回复
+ *
+ * 设置时为 BITFIELD key SET u1 <pos> 1 ...，读取时为 BITFIELD key GET u1 <pos> ...，
+ * 与逐个SETBIT/GETBIT使用相同的位序，已有的位图不受影响。
+ * 位位置按字符串传参，不会像%d那样在超过2^31时溢出。
+ * 打开publish_adds时设置命令后面再追加 PUBLISH <key>:adds +<元素>，两条命令一起发出，仍然只有一次往返。
+ */
+bool BloomFilter::append_bitfield(const std::string& element, bool set)
+{
+	size_t positions[MAX_HASHES];
+	calculate_bit_positions(element, positions);
+
+	vector<string> args = { "BITFIELD", m_redis_key };
+	args.reserve(2 + m_num_hashes * (set ? 4 : 3));
+	for (size_t i = 0; i < m_num_hashes; ++i) {
+		args.push_back(set ? "SET" : "GET");
+		args.push_back("u1");
+		args.push_back(to_string(positions[i]));
+		if (set) args.push_back("1");
+	}
+
+	vector<const char*> argv;
+	vector<size_t> argvlen;
+	for (const string& arg : args) {
+		argv.push_back(arg.data());
+		argvlen.push_back(arg.size());
+	}
+
+	if (redisAppendCommandArgv(m_redis_conn, static_cast<int>(argv.size()), argv.data(), argvlen.data()) != REDIS_OK) return false;
+	if (!set || !m_publish_adds) return true;
+
+	string channel = mirror_channel();
+	string message = "+" + element;
+	return redisAppendCommand(m_redis_conn, "PUBLISH %b %b", channel.data(), channel.size(), message.data(), message.size()) == REDIS_OK;
+}
+
+/**
+ * @brief 读取一条BITFIELD的回复，以及打开publish_adds时跟在设置命令后面的PUBLISH回复
+ *
+ * @param reply 输出BITFIELD的回复（调用方负责释放）；Redis返回错误时为nullptr
+ * @return 连接出错时返回false，连接已被丢弃；Redis返回错误不影响后面的回复，返回true
+ */
+bool BloomFilter::read_bitfield_reply(bool set, redisReply*& reply)
+{
+	reply = nullptr;
+	void* raw = nullptr;
+	if (redisGetReply(m_redis_conn, &raw) != REDIS_OK || raw == nullptr) {
+		std::cerr << "Redis connection error: " << m_redis_conn->errstr << std::endl;
+		drop_connection();
+		return false;
+	}
+
+	reply = static_cast<redisReply*>(raw);
+
+	// PUBLISH跟在BITFIELD后面一起发出，BITFIELD出错时它的回复也已经在路上，必须读掉
+	if (set && m_publish_adds) {
+		void* published = nullptr;
+		if (redisGetReply(m_redis_conn, &published) != REDIS_OK || published == nullptr) {
 			freeReplyObject(reply);
+			reply = nullptr;
+			drop_connection();
 			return false;
 		}
+		freeReplyObject(published);
+	}
+
+	if (reply->type != REDIS_REPLY_ARRAY) {
+		if (reply->type == REDIS_REPLY_ERROR) std::cerr << "BITFIELD error: " << reply->str << std::endl;
+		freeReplyObject(reply);
+		reply = nullptr;
+	}
+	return true;
+}
+
+void BloomFilter::drop_connection()
+{
+	// 借用的连接留给所有者处理，出错标志仍在，connection()会拒绝使用它
+	if (m_redis_conn && m_owns_conn) {
+		redisFree(m_redis_conn);
+		m_redis_conn = nullptr;
+	}
+}
+
+redisContext* BloomFilter::connection()
+{
+	// hiredis的上下文出错后不能再使用
+	if (!m_owns_conn) {
+		if (m_redis_conn == nullptr || m_redis_conn->err) throw runtime_error("Redis connection lost");
+		return m_redis_conn;
+	}
+	if (m_redis_conn != nullptr && m_redis_conn->err) drop_connection();
+	if (m_redis_conn == nullptr) m_redis_conn = open_connection();
+	return m_redis_conn;
+}
+
+bool BloomFilter::ensure_connection()
+{
+	if (!m_owns_conn) return m_redis_conn != nullptr && !m_redis_conn->err;
+	try {
+		connection();
+		return true;
+	} catch (const exception& e) {
+		std::cerr << "Redis reconnect failed: " << e.what() << std::endl;
+		return false;
+	}
+}
+
+/**
+ * @brief 把Redis中的位图复制到本地过滤器
+ *
+ * 以流水线方式分段GETRANGE。key不存在或比位图短时（末尾的位从未被设置），缺少的部分为0
+ *
+ * @param local 目标本地过滤器，原有内容被覆盖
+ */
+void BloomFilter::export_to(LocalBloomFilter& local)
+{
+	check_compatible(local);
+	read_bitmap(connection(), local.data(), local.bitmap_bytes());
+}
+
+/**
+ * @brief 通过conn以流水线方式分段GETRANGE，把位图读入out
+ *
+ * @param total 位图的字节数，key比它短的部分为0
+ */
+void BloomFilter::read_bitmap(redisContext* conn, char* out, size_t total) const
+{
+	size_t chunks = (total + TRANSFER_CHUNK - 1) / TRANSFER_CHUNK;
+	const size_t window = 16;
+	std::memset(out, 0, total);
+
+	size_t sent = 0;
+	string error;
+	for (size_t received = 0; received < chunks; ++received) {
+		while (sent < chunks && sent - received < window) {
+			string start = to_string(sent * TRANSFER_CHUNK);
+			string end = to_string(min(total, (sent + 1) * TRANSFER_CHUNK) - 1);
+			const char* argv[] = { "GETRANGE", m_redis_key.c_str(), start.c_str(), end.c_str() };
+			size_t argvlen[] = { 8, m_redis_key.size(), start.size(), end.size() };
+			if (redisAppendCommandArgv(conn, 4, argv, argvlen) != REDIS_OK) {
+				throw runtime_error("GETRANGE failed: " + string(conn->errstr));
+			}
+			++sent;
+		}
 
+		void* raw = nullptr;
+		if (redisGetReply(conn, &raw) != REDIS_OK || raw == nullptr) {
+			throw runtime_error("GETRANGE failed: " + string(conn->errstr));
+		}
+		// Redis返回错误时读完剩下的回复再抛出，连接上不留未读的回复
+		redisReply* reply = static_cast<redisReply*>(raw);
+		if (reply->type != REDIS_REPLY_STRING) {
+			if (error.empty()) error = reply->type == REDIS_REPLY_ERROR ? reply->str : "unexpected reply";
+		} else if (error.empty()) {
+			size_t offset = received * TRANSFER_CHUNK;
+			std::memcpy(out + offset, reply->str, min(reply->len, total - offset));
+		}
 		freeReplyObject(reply);
 	}
+	if (!error.empty()) throw runtime_error("GETRANGE failed: " + error);
+}
+
+/**
+ * @brief 用本地过滤器的位图替换Redis中的位图
+ *
+ * 先分段SETRANGE到临时键，写完后RENAME覆盖原键，其他客户端不会读到写了一半的位图。
+ * 最后在 <key>:adds 频道上发布"!"，各个本地镜像收到后整体重新加载
+ *
+ * @param local 源本地过滤器
+ */
+void BloomFilter::import_from(const LocalBloomFilter& local)
+{
+	check_compatible(local);
+
+	string tmp_key = m_redis_key + ":import";
+	connection();
+	redisReply* reply = static_cast<redisReply*>(redisCommand(m_redis_conn, "DEL %b", tmp_key.data(), tmp_key.size()));
+	if (reply == nullptr) throw runtime_error("DEL failed: " + string(m_redis_conn->errstr));
+	freeReplyObject(reply);
+
+	size_t total = local.bitmap_bytes();
+	size_t chunks = (total + TRANSFER_CHUNK - 1) / TRANSFER_CHUNK;
+	const size_t window = 16;
+	const char* in = local.data();
 
-	// 所有位都为1，元素可能存在
+	size_t sent = 0;
+	string error;
+	for (size_t received = 0; received < chunks; ++received) {
+		while (sent < chunks && sent - received < window) {
+			size_t offset = sent * TRANSFER_CHUNK;
+			string start = to_string(offset);
+			const char* argv[] = { "SETRANGE", tmp_key.c_str(), start.c_str(), in + offset };
+			size_t argvlen[] = { 8, tmp_key.size(), start.size(), min(TRANSFER_CHUNK, total - offset) };
+			if (redisAppendCommandArgv(m_redis_conn, 4, argv, argvlen) != REDIS_OK) {
+				throw runtime_error("SETRANGE failed: " + string(m_redis_conn->errstr));
+			}
+			++sent;
+		}
+
+		void* raw = nullptr;
+		if (redisGetReply(m_redis_conn, &raw) != REDIS_OK || raw == nullptr) {
+			throw runtime_error("SETRANGE failed: " + string(m_redis_conn->errstr));
+		}
+		reply = static_cast<redisReply*>(raw);
+		if (reply->type == REDIS_REPLY_ERROR && error.empty()) error = reply->str;
+		freeReplyObject(reply);
+	}
+	if (!error.empty()) throw runtime_error("SETRANGE failed: " + error);
+
+	reply = static_cast<redisReply*>(redisCommand(m_redis_conn, "RENAME %b %b",
+		tmp_key.data(), tmp_key.size(), m_redis_key.data(), m_redis_key.size()));
+	if (reply == nullptr) throw runtime_error("RENAME failed: " + string(m_redis_conn->errstr));
+	if (reply->type == REDIS_REPLY_ERROR) error = reply->str;
+	freeReplyObject(reply);
+	if (!error.empty()) throw runtime_error("RENAME failed: " + error);
+
+	// 通知各个镜像整体重新加载；本进程的镜像直接复制
+	string channel = mirror_channel();
+	reply = static_cast<redisReply*>(redisCommand(m_redis_conn, "PUBLISH %b !", channel.data(), channel.size()));
+	if (reply == nullptr) throw runtime_error("PUBLISH failed: " + string(m_redis_conn->errstr));
+	freeReplyObject(reply);
+
+	if (m_mirrored) {
+		std::unique_lock<std::shared_mutex> lock(m_mirror_mutex);
+		std::memcpy(m_mirror.data(), local.data(), m_mirror.size());
+	}
+}
+
+/**
+ * @brief 检查本地过滤器与当前过滤器的布局和参数是否一致
+ */
+void BloomFilter::check_compatible(const LocalBloomFilter& local) const
+{
+	if (m_layout != BloomLayout::Blocked) {
+		throw invalid_argument("only BloomLayout::Blocked filters can be copied to/from LocalBloomFilter");
+	}
+	if (local.bitmap_bits() != m_bitmap_size || local.num_hashes() != m_num_hashes) {
+		throw invalid_argument("LocalBloomFilter parameters do not match the Redis filter");
+	}
+}
+
+/**
+ * @brief 开启本地镜像
+ *
+ * 先订阅再加载：订阅之后发布的添加都会收到消息，订阅之前的添加都已经在加载的位图中。
+ * 两者重叠的部分重复设置同样的位，没有影响，所以镜像不会漏掉任何添加。
+ * 镜像只能收到打开了publish_adds的写入方的添加，其他写入方的添加要等下一次整体重新加载才可见
+ */
+void BloomFilter::enable_mirror()
+{
+	if (!m_owns_conn) {
+		throw invalid_argument("filters on a borrowed connection can not be mirrored");
+	}
+	if (m_mirrored) return;
+
+	m_mirror.assign(bitmap_bytes(), 0);
+	m_sub_conn = subscribe_mirror();
+	try {
+		read_bitmap(connection(), reinterpret_cast<char*>(m_mirror.data()), m_mirror.size());
+	} catch (...) {
+		redisFree(m_sub_conn);
+		m_sub_conn = nullptr;
+		m_mirror.clear();
+		throw;
+	}
+
+	m_mirrored = true;
+	m_mirror_thread = std::thread(&BloomFilter::mirror_loop, this);
+}
+
+/**
+ * @brief 停止后台线程，释放订阅连接
+ */
+void BloomFilter::stop_mirror()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sub_mutex);
+		m_stop = true;
+		// 关闭订阅连接的socket，让阻塞在redisGetReply上的后台线程返回
+		if (m_sub_conn) ::shutdown(m_sub_conn->fd, SHUT_RDWR);
+	}
+	m_stop_cond.notify_all();
+	if (m_mirror_thread.joinable()) m_mirror_thread.join();
+
+	if (m_sub_conn) {
+		redisFree(m_sub_conn);
+		m_sub_conn = nullptr;
+	}
+}
+
+redisContext* BloomFilter::open_connection() const
+{
+	struct timeval timeout = { 1, 500000 }; // 1.5 秒
+
+	redisOptions options;
+	memset(&options, 0, sizeof(redisOptions));
+	REDIS_OPTIONS_SET_TCP(&options, m_redis_host.c_str(), m_redis_port);
+	options.connect_timeout = &timeout;
+	options.command_timeout = &timeout;
+
+	redisContext* conn = redisConnectWithOptions(&options);
+	if (conn == nullptr) throw runtime_error("can not allocate redis context");
+	if (conn->err) {
+		string error = conn->errstr;
+		redisFree(conn);
+		throw runtime_error("connect " + m_redis_host + ":" + to_string(m_redis_port) + ": " + error);
+	}
+
+	if (!m_redis_password.empty()) {
+		redisReply* reply = static_cast<redisReply*>(redisCommand(conn, "AUTH %b", m_redis_password.data(), m_redis_password.size()));
+		bool ok = reply != nullptr && reply->type != REDIS_REPLY_ERROR;
+		if (reply) freeReplyObject(reply);
+		if (!ok) {
+			redisFree(conn);
+			throw runtime_error("AUTH failed on " + m_redis_host + ":" + to_string(m_redis_port));
+		}
+	}
+	return conn;
+}
+
+/**
+ * @brief 新建连接并订阅添加频道
+ *
+ * 订阅后取消命令超时，后台线程一直阻塞等待消息
+ */
+redisContext* BloomFilter::subscribe_mirror() const
+{
+	redisContext* conn = open_connection();
+	string channel = mirror_channel();
+	redisReply* reply = static_cast<redisReply*>(redisCommand(conn, "SUBSCRIBE %b", channel.data(), channel.size()));
+	bool ok = reply != nullptr && reply->type == REDIS_REPLY_ARRAY;
+	if (reply) freeReplyObject(reply);
+	if (!ok) {
+		redisFree(conn);
+		throw runtime_error("SUBSCRIBE " + channel + " failed");
+	}
+
+	struct timeval no_timeout = { 0, 0 };
+	redisSetTimeout(conn, no_timeout);
+	return conn;
+}
+
+/**
+ * @brief 用一条新连接把位图整体加载到新的本地过滤器，加载完成后替换镜像
+ *
+ * 加载期间查询继续使用旧的镜像
+ */
+void BloomFilter::reload_mirror()
+{
+	vector<unsigned char> fresh(bitmap_bytes());
+	redisContext* conn = open_connection();
+	try {
+		read_bitmap(conn, reinterpret_cast<char*>(fresh.data()), fresh.size());
+	} catch (...) {
+		redisFree(conn);
+		throw;
+	}
+	redisFree(conn);
+
+	std::unique_lock<std::shared_mutex> lock(m_mirror_mutex);
+	m_mirror.swap(fresh);
+}
+
+/**
+ * @brief 把元素的k个位设置到镜像中
+ *
+ * 按Redis的位序：第p位在第p/8个字节中，从最高位往最低位数
+ */
+void BloomFilter::mirror_add(const std::string& element)
+{
+	size_t positions[MAX_HASHES];
+	calculate_bit_positions(element, positions);
+
+	std::unique_lock<std::shared_mutex> lock(m_mirror_mutex);
+	for (size_t i = 0; i < m_num_hashes; ++i) {
+		m_mirror[positions[i] / 8] |= static_cast<unsigned char>(0x80 >> (positions[i] % 8));
+	}
+}
+
+/**
+ * @brief 在镜像中检查元素的k个位
+ */
+bool BloomFilter::mirror_contains(const std::string& element) const
+{
+	size_t positions[MAX_HASHES];
+	calculate_bit_positions(element, positions);
+
+	std::shared_lock<std::shared_mutex> lock(m_mirror_mutex);
+	for (size_t i = 0; i < m_num_hashes; ++i) {
+		if (!(m_mirror[positions[i] / 8] & (0x80 >> (positions[i] % 8)))) return false;
+	}
 	return true;
 }
 
+/**
+ * @brief 处理订阅连接上的一条消息
+ *
+ * "+<元素>" 把元素加入镜像，"!" 整体重新加载
+ *
+ * @return 重新加载失败时返回false，由调用方按断线处理
+ */
+bool BloomFilter::on_mirror_message(redisReply* reply)
+{
+	if (reply->type != REDIS_REPLY_ARRAY || reply->elements != 3) return true;
+	redisReply* payload = reply->element[2];
+	if (payload->type != REDIS_REPLY_STRING || payload->len == 0) return true;
+
+	if (payload->str[0] == '+') {
+		mirror_add(string(payload->str + 1, payload->len - 1));
+		return true;
+	}
+
+	if (payload->str[0] == '!') {
+		try {
+			reload_mirror();
+		} catch (const exception& e) {
+			std::cerr << "Mirror reload failed: " << e.what() << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief 后台线程：阻塞读取添加消息并应用到镜像
+ *
+ * 订阅连接断开期间的消息已经丢失，按指数退避重新订阅，再整体重新加载
+ */
+void BloomFilter::mirror_loop()
+{
+	std::chrono::milliseconds backoff = RECONNECT_MIN;
+	for (;;) {
+		redisContext* sub;
+		{
+			std::lock_guard<std::mutex> lock(m_sub_mutex);
+			if (m_stop) return;
+			sub = m_sub_conn;
+		}
+
+		if (sub != nullptr) {
+			void* raw = nullptr;
+			if (redisGetReply(sub, &raw) == REDIS_OK && raw != nullptr) {
+				bool ok = on_mirror_message(static_cast<redisReply*>(raw));
+				freeReplyObject(raw);
+				if (ok) continue;
+			}
+
+			std::lock_guard<std::mutex> lock(m_sub_mutex);
+			if (m_stop) return;
+			m_sub_conn = nullptr;
+			redisFree(sub);
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(m_sub_mutex);
+			if (m_stop_cond.wait_for(lock, backoff, [this] { return m_stop; })) return;
+		}
+
+		try {
+			redisContext* fresh = subscribe_mirror();
+			{
+				std::lock_guard<std::mutex> lock(m_sub_mutex);
+				if (m_stop) {
+					redisFree(fresh);
+					return;
+				}
+				m_sub_conn = fresh;
+			}
+			reload_mirror();
+			backoff = RECONNECT_MIN;
+			continue;
+		} catch (const exception& e) {
+			std::cerr << "Mirror resync failed: " << e.what() << std::endl;
+		}
+
+		// 订阅成功但加载失败：断开订阅，下一轮重新来过
+		{
+			std::lock_guard<std::mutex> lock(m_sub_mutex);
+			if (m_stop) return;
+			if (m_sub_conn) {
+				redisFree(m_sub_conn);
+				m_sub_conn = nullptr;
+			}
+		}
+		backoff = std::min(backoff * 2, RECONNECT_MAX);
+	}
+}
+
+/**
+ * @brief 位图中为1的位所占的比例
+ *
+ * 按最优参数建立的过滤器在装满expected_items个元素时约为50%，超过之后误判率随之上升
+ */
+double BloomFilter::fill_ratio()
+{
+	redisReply* reply = static_cast<redisReply*>(redisCommand(connection(), "BITCOUNT %b", m_redis_key.data(), m_redis_key.size()));
+	if (reply == nullptr) throw runtime_error("BITCOUNT failed: " + string(m_redis_conn->errstr));
+	if (reply->type != REDIS_REPLY_INTEGER) {
+		string error = reply->type == REDIS_REPLY_ERROR ? reply->str : "unexpected reply";
+		freeReplyObject(reply);
+		throw runtime_error("BITCOUNT failed: " + error);
+	}
+	long long ones = reply->integer;
+	freeReplyObject(reply);
+	return static_cast<double>(ones) / m_bitmap_size;
+}
+
 /**
  * @brief 获取布隆过滤器的统计信息
  */
@@ -136,6 +801,8 @@ void BloomFilter::print_stats() const
 	std::cout << "  Bitmap size: " << m_bitmap_size << " bits ("
 		<< (m_bitmap_size / 8 / 1024.0) << " KB)\n";
 	std::cout << "  Number of hash functions: " << m_num_hashes << "\n";
+	std::cout << "  Layout: " << (m_layout == BloomLayout::Blocked ? "blocked" : "standard") << "\n";
+	std::cout << "  Local mirror: " << (m_mirrored ? "on" : "off") << "\n";
 	std::cout << "  Expected false positive rate: "
 		<< (m_false_positive_rate * 100) << "%\n";
 }
@@ -145,6 +812,15 @@ void BloomFilter::print_stats() const
  */
 void BloomFilter::calculate_optimal_parameters(size_t n, double p) 
 {
+	if (m_layout == BloomLayout::Blocked) {
+		// 与LocalBloomFilter使用同一套计算，两端参数一致
+		size_t num_blocks;
+		blocked_bloom::optimal_parameters(n, p, num_blocks, m_num_hashes);
+		m_bitmap_size = num_blocks * blocked_bloom::BLOCK_BITS;
+		m_false_positive_rate = p;
+		return;
+	}
+
 	// 计算位图大小 m = - (n * ln(p)) / (ln(2)^2)
 	m_bitmap_size = static_cast<size_t>(-(n * log(p)) / (log(2) * log(2)));
 
@@ -154,39 +830,30 @@ void BloomFilter::calculate_optimal_parameters(size_t n, double p)
 	// 计算哈希函数数量 k = (m / n) * ln(2)
 	m_num_hashes = static_cast<size_t>(ceil((m_bitmap_size / static_cast<double>(n)) * log(2)));
 
-	// 至少需要1个哈希函数
+	// 至少需要1个哈希函数，最多MAX_HASHES个（对应约1e-9的误判率）
 	if (m_num_hashes == 0) m_num_hashes = 1;
+	if (m_num_hashes > MAX_HASHES) m_num_hashes = MAX_HASHES;
 
 	m_false_positive_rate = p;
 }
 
 /**
- * @brief 初始化哈希函数
+ * @brief 计算元素的全部k个位位置
+ *
+ * 只对元素做一次MurmurHash3 x64_128，第i个位置取 (h1 + i * h2) mod m（Kirsch-Mitzenmacher双重哈希），
+ * 误判率与k个独立的哈希函数渐近相同。Blocked布局下按local_bloom_filter.h中的分块规则计算。
+ *
+ * @param positions 输出，至少能容纳MAX_HASHES个位置
  */
-void BloomFilter::initialize_hash_functions() 
+void BloomFilter::calculate_bit_positions(const std::string& element, size_t* positions) const 
 {
-	// 使用不同的种子创建多个哈希函数
-	for (size_t i = 0; i < m_num_hashes; ++i) {
-		m_hash_functions.emplace_back([seed = i](const string& str) -> size_t {
-			// 简单的哈希函数实现 (FNV-1a算法)
-			const size_t prime = 0x100000001b3;
-			size_t hash = 0xcbf29ce484222325 ^ seed;
-
-			for (char c : str) {
-				hash ^= static_cast<size_t>(c);
-				hash *= prime;
-			}
+	Hash128 hash = murmur3_x64_128(element.data(), element.size());
+	if (m_layout == BloomLayout::Blocked) {
+		blocked_bloom::positions(hash, m_bitmap_size / blocked_bloom::BLOCK_BITS, m_num_hashes, positions);
+		return;
+	}
 
-			return hash;
-		});
+	for (size_t i = 0; i < m_num_hashes; ++i) {
+		positions[i] = (hash.h1 + i * hash.h2) % m_bitmap_size;
 	}
 }
-
-/**
- * @brief 计算位位置
- */
-size_t BloomFilter::calculate_bit_position(const std::string& element, size_t hash_index) const 
-{
-		size_t hash_value = m_hash_functions[hash_index](element);
-		return hash_value % m_bitmap_size;
-}
\ No newline at end of file
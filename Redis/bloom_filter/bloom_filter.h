@@ -6,39 +6,145 @@
 #include <cstring>
 #include <cmath>
 #include <functional>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <condition_variable>
 #include <hiredis/hiredis.h>
 
+#include "murmur3.h"
+#include "local_bloom_filter.h"
+
+// 位图布局
+enum class BloomLayout {
+    Standard,   // k个位分散在整个位图中
+    Blocked,    // k个位落在同一个64字节块中，与LocalBloomFilter相同，可以互相导入导出
+};
+
 class BloomFilter {
 public:
     BloomFilter(const std::string& redis_host, int redis_port,
                 const std::string& key, 
                 const std::string& password = "",
                 size_t expected_items = 10000, 
-                double false_positive_rate = 0.01);
+                double false_positive_rate = 0.01,
+                BloomLayout layout = BloomLayout::Standard);
+
+    // 借用调用方的连接，不认证、不打印、不重连，也不释放连接；Redis出错时抛出std::runtime_error而不是按可能存在处理。
+    // 供由多个过滤器组成的结构使用（如ScalableBloomFilter的各层），连接断开后由所有者重新连接并调用attach
+    BloomFilter(redisContext* conn,
+                const std::string& key,
+                size_t expected_items = 10000,
+                double false_positive_rate = 0.01,
+                BloomLayout layout = BloomLayout::Standard);
 
     ~BloomFilter();
 
+    BloomFilter(const BloomFilter&) = delete;
+    BloomFilter& operator=(const BloomFilter&) = delete;
+
+    // 换用所有者重新建立的连接，只用于借用连接的过滤器
+    void attach(redisContext* conn) { m_redis_conn = conn; }
+
     // 连接 Redis
     void connect_redis(const std::string& redis_host, int redis_port);
 
-    // 向布隆过滤器中添加元素
-    void add(const std::string& element);
+    // 向布隆过滤器中添加元素，返回是否有位从0变为1（false表示元素可能已经存在，或Redis出错）
+    bool add(const std::string& element);
 
     // 检查元素是否可能存在于布隆过滤器中
     bool searchKey(const std::string& element);
 
+    // 批量添加，流水线发送，最多window条命令在途
+    void add_many(const std::vector<std::string>& elements, size_t window = 1024);
+
+    // 批量检查，结果与elements一一对应
+    std::vector<bool> contains_many(const std::vector<std::string>& elements, size_t window = 1024);
+
+    // 把Redis中的位图整体复制到本地过滤器，之后本地查询不再访问网络。
+    // 要求Blocked布局且与local的expected_items和误判率相同，否则抛出std::invalid_argument
+    void export_to(LocalBloomFilter& local);
+
+    // 用本地过滤器的位图整体替换Redis中的位图，要求同上
+    void import_from(const LocalBloomFilter& local);
+
+    // 开启本地镜像：订阅 <key>:adds 频道后把整个位图加载到本地，之后searchKey/contains_many只查本地（纳秒级），
+    // add/add_many仍然写入Redis并同时写入镜像。后台线程把其他客户端发布的添加应用到镜像，订阅断开时重连并整体重新加载，
+    // 重连期间继续用已有的镜像回答查询。两种布局都可以镜像；借用连接的过滤器抛出std::invalid_argument，Redis出错时抛出std::runtime_error。
+    // 开启后searchKey/contains_many可以在多个线程中并发调用，其他方法仍然只能在一个线程中使用
+    void enable_mirror();
+    bool mirrored() const { return m_mirrored; }
+
+    // 添加时是否在 <key>:adds 频道上发布元素，默认关闭。其他进程开启了镜像时，写入方必须打开，否则那些镜像看不到它的添加；
+    // 打开后每次添加多一条PUBLISH（与BITFIELD一起发出，不增加往返）
+    void publish_adds(bool enable) { m_publish_adds = enable; }
+
+    // 位图中为1的位所占的比例（BITCOUNT），出错时抛出std::runtime_error
+    double fill_ratio();
+
+    const std::string& key() const { return m_redis_key; }
+    size_t bitmap_bits() const { return m_bitmap_size; }
+    size_t num_hashes() const { return m_num_hashes; }
+    double false_positive_rate() const { return m_false_positive_rate; }
+
     // 获取布隆过滤器的统计信息
     void print_stats() const;
 
 private:
+    // 哈希函数数量上限，位位置放在栈上的定长数组里，不需要堆分配
+    static constexpr size_t MAX_HASHES = 32;
+
     // 计算最优的位图大小和哈希函数数量
     void calculate_optimal_parameters(size_t n, double p);
 
-    // 初始化哈希函数
-    void initialize_hash_functions();
+    // 对元素哈希一次，用双重哈希推出全部k个位位置
+    void calculate_bit_positions(const std::string& element, size_t* positions) const;
+
+    // 对元素的k个位执行一条BITFIELD命令（SET或GET），一次往返完成
+    redisReply* bitfield(const std::string& element, bool set);
+
+    // 流水线发送整批BITFIELD命令，按顺序把每条回复交给on_reply
+    bool pipeline(const std::vector<std::string>& elements, bool set, size_t window,
+                  const std::function<void(size_t, redisReply*)>& on_reply);
+
+    // 追加一条BITFIELD命令到输出缓冲 / 读取一条回复；打开publish_adds时设置命令后面跟一条PUBLISH。
+    // 读取时连接出错返回false；Redis返回错误（OOM、WRONGTYPE等）时返回true，reply为nullptr
+    bool append_bitfield(const std::string& element, bool set);
+    bool read_bitfield_reply(bool set, redisReply*& reply);
+
+    // 连接出错后，输出缓冲和未读的回复已经无法对应，丢弃连接，下次使用时重新连接
+    void drop_connection();
+    // 返回可用的连接，必要时重新连接；重连失败时抛出std::runtime_error / 返回false
+    redisContext* connection();
+    bool ensure_connection();
+
+    // 导入导出前检查本地过滤器的参数是否与当前过滤器一致
+    void check_compatible(const LocalBloomFilter& local) const;
+
+    // 通过conn分段GETRANGE，把位图读入out（bytes字节）
+    void read_bitmap(redisContext* conn, char* out, size_t bytes) const;
 
-    // 计算位位置
-    size_t calculate_bit_position(const std::string& element, size_t hash_index) const;
+    // 新建一条连接（失败时抛出std::runtime_error），供镜像的订阅和重新加载使用
+    redisContext* open_connection() const;
+
+    // 镜像：订阅添加频道 / 用新连接整体重新加载 / 处理一条频道消息 / 后台线程
+    std::string mirror_channel() const { return m_redis_key + ":adds"; }
+    size_t bitmap_bytes() const { return (m_bitmap_size + 7) / 8; }
+    void mirror_add(const std::string& element);
+    bool mirror_contains(const std::string& element) const;
+    redisContext* subscribe_mirror() const;
+    void reload_mirror();
+    bool on_mirror_message(redisReply* reply);
+    void mirror_loop();
+    void stop_mirror();
+
+    static constexpr std::chrono::milliseconds RECONNECT_MIN{100};
+    static constexpr std::chrono::milliseconds RECONNECT_MAX{5000};
+
+    // 导入导出时每条GETRANGE/SETRANGE传输的字节数
+    static constexpr size_t TRANSFER_CHUNK = 1 << 20;
 
     redisContext* m_redis_conn;             // Redis 连接
     std::string m_redis_key;                // Redis 键名
@@ -47,6 +153,23 @@ private:
     size_t m_bitmap_size;                   // 位图大小（位数）
     size_t m_num_hashes;                    // 哈希函数数量
     double m_false_positive_rate;           // 误判率
-    
-    std::vector<std::function<size_t(const std::string&)>> m_hash_functions;
+    BloomLayout m_layout;                   // 位图布局
+
+    // 本地镜像：与Redis中的字符串逐字节相同的位图，用calculate_bit_positions查询，两种布局通用。
+    // 重新加载时整体替换；查询持共享锁，写入和替换持独占锁
+    const std::string m_redis_host;
+    const int m_redis_port;
+    bool m_publish_adds = false;
+    bool m_mirrored = false;
+    std::vector<unsigned char> m_mirror;
+    mutable std::shared_mutex m_mirror_mutex;
+
+    // 订阅连接，由后台线程使用
+    std::mutex m_sub_mutex;
+    std::condition_variable m_stop_cond;
+    redisContext* m_sub_conn = nullptr;
+    bool m_stop = false;
+    std::thread m_mirror_thread;
+
+    bool m_owns_conn = true;                // false 表示借用的连接
 };
\ No newline at end of file
@@ -0,0 +1,544 @@
+#include "cuckoo_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+// 装满时的目标装载率，每桶4个槽的布谷鸟哈希在95%左右开始频繁失败
+constexpr double MAX_LOAD = 0.95;
+
+// save() 每条SETRANGE最多传输的字节数
+constexpr size_t TRANSFER_CHUNK = 1 << 20;
+
+redisContext* connect_redis_node(const string& host, int port, const string& password)
+{
+	struct timeval timeout = { 1, 500000 }; // 1.5 秒
+
+	redisOptions options;
+	memset(&options, 0, sizeof(redisOptions));
+	REDIS_OPTIONS_SET_TCP(&options, host.c_str(), port);
+	options.connect_timeout = &timeout;
+	options.command_timeout = &timeout;
+
+	redisContext* conn = redisConnectWithOptions(&options);
+	if (conn == nullptr) throw runtime_error("can not allocate redis context");
+	if (conn->err) {
+		string error = conn->errstr;
+		redisFree(conn);
+		throw runtime_error("connect " + host + ":" + to_string(port) + ": " + error);
+	}
+
+	if (!password.empty()) {
+		redisReply* reply = static_cast<redisReply*>(redisCommand(conn, "AUTH %b", password.data(), password.size()));
+		bool ok = reply != nullptr && reply->type != REDIS_REPLY_ERROR;
+		if (reply) freeReplyObject(reply);
+		if (!ok) {
+			redisFree(conn);
+			throw runtime_error("AUTH failed on " + host + ":" + to_string(port));
+		}
+	}
+	return conn;
+}
+
+// 半排序桶的编码表：所有单调不减的4位四元组 (a, b, c, d)，打包为 a<<12 | b<<8 | c<<4 | d。
+// 按字典序生成，打包后的值也是递增的，编码时二分查找，解码时直接下标访问
+constexpr size_t NIBBLE_BITS = 4;
+constexpr size_t TUPLE_BITS = 12;
+constexpr size_t NUM_TUPLES = 3876;     // C(16 + 4 - 1, 4)
+
+const uint16_t* sorted_tuples()
+{
+	static const vector<uint16_t> tuples = [] {
+		vector<uint16_t> t;
+		t.reserve(NUM_TUPLES);
+		for (unsigned a = 0; a < 16; ++a)
+			for (unsigned b = a; b < 16; ++b)
+				for (unsigned c = b; c < 16; ++c)
+					for (unsigned d = c; d < 16; ++d)
+						t.push_back(static_cast<uint16_t>(a << 12 | b << 8 | c << 4 | d));
+		return t;
+	}();
+	return tuples.data();
+}
+
+uint64_t reply_to_u64(const redisReply* reply)
+{
+	if (reply->type == REDIS_REPLY_INTEGER) return static_cast<uint64_t>(reply->integer);
+	if (reply->type == REDIS_REPLY_STRING) return stoull(string(reply->str, reply->len));
+	throw runtime_error("unexpected meta field");
+}
+
+}  // namespace
+
+/**
+ * @brief 构造函数
+ *
+ * 指纹位数 f = ceil(log2(2 * 4 / p))（至少4位，高4位参与半排序），桶数 = ceil(expected_items / (4 * 0.95))
+ *
+ * @param key Redis 中存储表的键名
+ * @param expected_items 预期存储的元素数量
+ * @param false_positive_rate 可接受的误判率 (0.01 表示 1%)
+ */
+CuckooFilter::CuckooFilter(const std::string& redis_host, int redis_port,
+	const std::string& key,
+	const std::string& password,
+	size_t expected_items,
+	double false_positive_rate) :m_redis_conn(nullptr), m_redis_key(key),
+	m_redis_host(redis_host), m_redis_port(redis_port), m_redis_password(password),
+	m_target_false_positive_rate(false_positive_rate), m_count(0),
+	m_has_victim(false), m_victim_index(0), m_victim_fingerprint(0), m_random(0x9e3779b97f4a7c15ULL)
+{
+	if (false_positive_rate <= 0.0 || false_positive_rate >= 1.0) {
+		throw invalid_argument("false_positive_rate must be in (0, 1)");
+	}
+
+	double n = expected_items > 0 ? static_cast<double>(expected_items) : 1.0;
+	m_num_buckets = static_cast<uint64_t>(std::ceil(n / (SLOTS_PER_BUCKET * MAX_LOAD)));
+
+	double bits = std::ceil(std::log2(2.0 * SLOTS_PER_BUCKET / false_positive_rate));
+	m_fingerprint_bits = static_cast<size_t>(std::min(32.0, std::max(4.0, bits)));
+	m_fingerprint_mask = m_fingerprint_bits == 32 ? 0xffffffffU : (1U << m_fingerprint_bits) - 1;
+
+	m_table.assign(table_bytes() + 8, 0);
+	m_dirty.assign((table_bytes() + PAGE_BYTES - 1) / PAGE_BYTES, true);
+
+	m_redis_conn = connect_redis_node(redis_host, redis_port, password);
+}
+
+CuckooFilter::~CuckooFilter()
+{
+	if (m_redis_conn) {
+		redisFree(m_redis_conn);
+	}
+}
+
+/**
+ * @brief 添加元素
+ *
+ * 两个候选桶都满时，随机挤出一个指纹，把它搬到它的另一个候选桶，依次进行直到找到空槽。
+ * 搬动MAX_KICKS次仍未成功时，之后的添加都会失败
+ *
+ * @param element 要添加的元素
+ * @return true 添加成功
+ * @return false 表已满
+ */
+bool CuckooFilter::add(const std::string& element)
+{
+	if (m_has_victim) return false;
+
+	Candidates c = candidates(element);
+	++m_count;
+	if (insert_into(c.i1, c.fingerprint) || insert_into(c.i2, c.fingerprint)) return true;
+
+	place((next_random() & 1) ? c.i1 : c.i2, c.fingerprint);
+	return true;
+}
+
+/**
+ * @brief 检查元素是否可能存在
+ *
+ * @param element 要检查的元素
+ * @return true 元素可能存在（可能有误判）
+ * @return false 元素绝对不存在
+ */
+bool CuckooFilter::contains(const std::string& element) const
+{
+	Candidates c = candidates(element);
+	if (bucket_has(c.i1, c.fingerprint) || bucket_has(c.i2, c.fingerprint)) return true;
+	return m_has_victim && m_victim_fingerprint == c.fingerprint && (m_victim_index == c.i1 || m_victim_index == c.i2);
+}
+
+/**
+ * @brief 删除元素
+ *
+ * 删除一个指纹后表中有了空位，候选槽中的指纹重新放回表中
+ *
+ * @param element 之前添加过的元素
+ * @return true 找到并删除了元素的指纹
+ * @return false 表中没有这个指纹
+ */
+bool CuckooFilter::remove(const std::string& element)
+{
+	Candidates c = candidates(element);
+	if (erase_from(c.i1, c.fingerprint) || erase_from(c.i2, c.fingerprint)) {
+		--m_count;
+		if (m_has_victim) {
+			m_has_victim = false;
+			uint64_t index = m_victim_index;
+			uint32_t fingerprint = m_victim_fingerprint;
+			if (!insert_into(index, fingerprint) && !insert_into(alt_index(index, fingerprint), fingerprint)) {
+				place(index, fingerprint);
+			}
+		}
+		return true;
+	}
+
+	if (m_has_victim && m_victim_fingerprint == c.fingerprint && (m_victim_index == c.i1 || m_victim_index == c.i2)) {
+		m_has_victim = false;
+		--m_count;
+		return true;
+	}
+	return false;
+}
+
+void CuckooFilter::clear()
+{
+	std::fill(m_table.begin(), m_table.end(), 0);
+	std::fill(m_dirty.begin(), m_dirty.end(), true);
+	m_count = 0;
+	m_has_victim = false;
+}
+
+/**
+ * @brief 从Redis读取表和元数据
+ *
+ * HMGET和GET放在一个事务中，读到的表和元数据一定对应同一次save。
+ * 读取后所有页都视为未修改，下次save只写之后的修改
+ *
+ * @return false Redis中没有这个过滤器，本地的表不变
+ */
+bool CuckooFilter::load()
+{
+	redisContext* conn = connection();
+	string meta_key = m_redis_key + ":meta";
+	redisAppendCommand(conn, "MULTI");
+	redisAppendCommand(conn, "HMGET %b buckets fingerprint_bits count victim_index victim_fingerprint bucket_bits",
+		meta_key.data(), meta_key.size());
+	redisAppendCommand(conn, "GET %b", m_redis_key.data(), m_redis_key.size());
+	if (redisAppendCommand(conn, "EXEC") != REDIS_OK) {
+		throw runtime_error("load failed: " + string(conn->errstr));
+	}
+
+	// 读完MULTI、HMGET、GET、EXEC四条回复再报告错误，连接上不留下未读的回复
+	string error;
+	redisReply* exec = nullptr;
+	for (size_t i = 0; i < 4; ++i) {
+		void* raw = nullptr;
+		if (redisGetReply(conn, &raw) != REDIS_OK || raw == nullptr) {
+			if (exec) freeReplyObject(exec);
+			throw runtime_error("load failed: " + string(conn->errstr));
+		}
+		redisReply* reply = static_cast<redisReply*>(raw);
+		if (reply->type == REDIS_REPLY_ERROR && error.empty()) error = reply->str;
+		if (i == 3) {
+			exec = reply;
+		} else {
+			freeReplyObject(reply);
+		}
+	}
+	if (error.empty() && exec->type == REDIS_REPLY_ARRAY) {
+		for (size_t i = 0; i < exec->elements && error.empty(); ++i) {
+			if (exec->element[i]->type == REDIS_REPLY_ERROR) error = exec->element[i]->str;
+		}
+	}
+	if (!error.empty()) {
+		freeReplyObject(exec);
+		throw runtime_error("load failed: " + error);
+	}
+	if (exec->type != REDIS_REPLY_ARRAY || exec->elements != 2 || exec->element[0]->type != REDIS_REPLY_ARRAY) {
+		freeReplyObject(exec);
+		throw runtime_error("load failed: unexpected reply");
+	}
+
+	redisReply** fields = exec->element[0]->element;
+	if (exec->element[0]->elements != 6 || fields[0]->type == REDIS_REPLY_NIL) {
+		freeReplyObject(exec);
+		return false;
+	}
+
+	// bucket_bits为空的是不带半排序的旧格式，同样按参数不一致处理
+	uint64_t values[6];
+	try {
+		for (size_t i = 0; i < 5; ++i) values[i] = reply_to_u64(fields[i]);
+		values[5] = fields[5]->type == REDIS_REPLY_NIL ? 0 : reply_to_u64(fields[5]);
+	} catch (...) {
+		freeReplyObject(exec);
+		throw runtime_error("load failed: corrupt " + meta_key);
+	}
+	if (values[0] != m_num_buckets || values[1] != m_fingerprint_bits || values[5] != bucket_bits()) {
+		freeReplyObject(exec);
+		throw invalid_argument("stored cuckoo filter parameters do not match");
+	}
+
+	vector<uint8_t> loaded(m_table.size(), 0);
+	const redisReply* table = exec->element[1];
+	if (table->type == REDIS_REPLY_STRING) {
+		std::memcpy(loaded.data(), table->str, std::min(table->len, table_bytes()));
+	}
+	freeReplyObject(exec);
+
+	// 12位的编号可以表示4096个值，超出编码表的说明数据已损坏
+	for (uint64_t bucket = 0; bucket < m_num_buckets; ++bucket) {
+		size_t bit = bucket * bucket_bits();
+		uint64_t word;
+		std::memcpy(&word, loaded.data() + bit / 8, sizeof(word));
+		if (((word >> (bit % 8)) & ((1U << TUPLE_BITS) - 1)) >= NUM_TUPLES) {
+			throw runtime_error("load failed: corrupt " + m_redis_key);
+		}
+	}
+
+	m_table.swap(loaded);
+	m_count = values[2];
+	m_has_victim = values[4] != 0;
+	m_victim_index = values[3];
+	m_victim_fingerprint = static_cast<uint32_t>(values[4]);
+	std::fill(m_dirty.begin(), m_dirty.end(), false);
+	return true;
+}
+
+/**
+ * @brief 把修改过的页和元数据写入Redis
+ *
+ * 相邻的修改页合并成一条SETRANGE（最多1MB），与HSET一起放在MULTI/EXEC中流水线发送，只有一次往返。
+ * 删除少量元素时只写几个4KB页，不需要重建整个表
+ */
+void CuckooFilter::save()
+{
+	const size_t max_run = TRANSFER_CHUNK / PAGE_BYTES;
+	size_t total = table_bytes();
+	size_t queued = 0;
+
+	redisContext* conn = connection();
+	redisAppendCommand(conn, "MULTI");
+	for (size_t page = 0; page < m_dirty.size();) {
+		if (!m_dirty[page]) {
+			++page;
+			continue;
+		}
+		size_t first = page;
+		while (page < m_dirty.size() && m_dirty[page] && page - first < max_run) ++page;
+
+		size_t offset = first * PAGE_BYTES;
+		size_t len = std::min(page * PAGE_BYTES, total) - offset;
+		string start = to_string(offset);
+		const char* argv[] = { "SETRANGE", m_redis_key.c_str(), start.c_str(), reinterpret_cast<const char*>(m_table.data()) + offset };
+		size_t argvlen[] = { 8, m_redis_key.size(), start.size(), len };
+		redisAppendCommandArgv(conn, 4, argv, argvlen);
+		++queued;
+	}
+
+	string meta_key = m_redis_key + ":meta";
+	string buckets = to_string(m_num_buckets);
+	string bits = to_string(m_fingerprint_bits);
+	string count = to_string(m_count);
+	string victim_index = to_string(m_has_victim ? m_victim_index : 0);
+	string victim_fingerprint = to_string(m_has_victim ? m_victim_fingerprint : 0);
+	string layout_bits = to_string(bucket_bits());
+	redisAppendCommand(conn, "HSET %b buckets %b fingerprint_bits %b count %b victim_index %b victim_fingerprint %b bucket_bits %b",
+		meta_key.data(), meta_key.size(), buckets.data(), buckets.size(), bits.data(), bits.size(),
+		count.data(), count.size(), victim_index.data(), victim_index.size(),
+		victim_fingerprint.data(), victim_fingerprint.size(), layout_bits.data(), layout_bits.size());
+	++queued;
+	if (redisAppendCommand(conn, "EXEC") != REDIS_OK) {
+		throw runtime_error("save failed: " + string(conn->errstr));
+	}
+
+	// 读完全部回复再报告错误，连接上不留下未读的回复
+	string error;
+	for (size_t i = 0; i < queued + 2; ++i) {
+		void* raw = nullptr;
+		if (redisGetReply(conn, &raw) != REDIS_OK || raw == nullptr) {
+			throw runtime_error("save failed: " + string(conn->errstr));
+		}
+		redisReply* reply = static_cast<redisReply*>(raw);
+		if (reply->type == REDIS_REPLY_ERROR && error.empty()) error = reply->str;
+		if (i == queued + 1 && reply->type == REDIS_REPLY_ARRAY) {
+			for (size_t j = 0; j < reply->elements && error.empty(); ++j) {
+				if (reply->element[j]->type == REDIS_REPLY_ERROR) error = reply->element[j]->str;
+			}
+		}
+		freeReplyObject(reply);
+	}
+	if (!error.empty()) throw runtime_error("save failed: " + error);
+
+	std::fill(m_dirty.begin(), m_dirty.end(), false);
+}
+
+redisContext* CuckooFilter::connection()
+{
+	// hiredis的上下文出错后不能再使用，输出缓冲和未读的回复随之丢弃
+	if (m_redis_conn->err) {
+		redisContext* fresh = connect_redis_node(m_redis_host, m_redis_port, m_redis_password);
+		redisFree(m_redis_conn);
+		m_redis_conn = fresh;
+	}
+	return m_redis_conn;
+}
+
+/**
+ * @brief 按当前装载率估计误判率
+ *
+ * 一次查询与两个桶中的已占用槽逐个比较，每个槽与随机指纹相同的概率为 1 / (2^f - 1)
+ */
+double CuckooFilter::false_positive_rate() const
+{
+	double match = 1.0 / (std::pow(2.0, static_cast<double>(m_fingerprint_bits)) - 1.0);
+	return 1.0 - std::pow(1.0 - match, 2.0 * SLOTS_PER_BUCKET * load_factor());
+}
+
+double CuckooFilter::bits_per_item() const
+{
+	return table_bytes() * 8.0 / (m_count > 0 ? m_count : 1);
+}
+
+void CuckooFilter::print_stats() const
+{
+	std::cout << "Cuckoo Filter Statistics:\n";
+	std::cout << "  Buckets: " << m_num_buckets << " x " << SLOTS_PER_BUCKET << " slots, fingerprint "
+		<< m_fingerprint_bits << " bits (" << (table_bytes() / 1024.0) << " KB)\n";
+	std::cout << "  Items: " << m_count << " (load factor " << (load_factor() * 100) << "%"
+		<< (m_has_victim ? ", full" : "") << ")\n";
+	std::cout << "  Bits per item: " << bits_per_item() << "\n";
+	std::cout << "  Estimated false positive rate: " << (false_positive_rate() * 100) << "% (target "
+		<< (m_target_false_positive_rate * 100) << "%)\n";
+}
+
+/**
+ * @brief 计算元素的指纹和两个候选桶
+ *
+ * 对元素做一次MurmurHash3 x64_128：h1映射到桶号，h2的高位作为指纹（0表示空槽，改为1）
+ */
+CuckooFilter::Candidates CuckooFilter::candidates(const std::string& element) const
+{
+	Hash128 hash = murmur3_x64_128(element.data(), element.size());
+
+	Candidates c;
+	c.i1 = static_cast<uint64_t>((static_cast<unsigned __int128>(hash.h1) * m_num_buckets) >> 64);
+	c.fingerprint = static_cast<uint32_t>(hash.h2 >> 32) & m_fingerprint_mask;
+	if (c.fingerprint == 0) c.fingerprint = 1;
+	c.i2 = alt_index(c.i1, c.fingerprint);
+	return c;
+}
+
+uint64_t CuckooFilter::alt_index(uint64_t index, uint32_t fingerprint) const
+{
+	uint64_t h = murmur3_detail::fmix64(fingerprint) % m_num_buckets;
+	return h >= index ? h - index : h + m_num_buckets - index;
+}
+
+void CuckooFilter::place(uint64_t index, uint32_t fingerprint)
+{
+	uint32_t fingerprints[SLOTS_PER_BUCKET];
+	for (size_t kick = 0; kick < MAX_KICKS; ++kick) {
+		read_bucket(index, fingerprints);
+		size_t slot = next_random() % SLOTS_PER_BUCKET;
+		uint32_t evicted = fingerprints[slot];
+		fingerprints[slot] = fingerprint;
+		write_bucket(index, fingerprints);
+		fingerprint = evicted;
+		index = alt_index(index, fingerprint);
+		if (insert_into(index, fingerprint)) return;
+	}
+
+	// 被挤出的是表中另一个元素的指纹，不能丢弃
+	m_has_victim = true;
+	m_victim_index = index;
+	m_victim_fingerprint = fingerprint;
+}
+
+// 第bucket个桶从第 bucket * (4f - 4) 位开始：先是12位的四元组编号，再是按大小排列的4个指纹各自的低 f - 4 位
+void CuckooFilter::read_bucket(uint64_t bucket, uint32_t* fingerprints) const
+{
+	size_t low_bits = m_fingerprint_bits - NIBBLE_BITS;
+	size_t bit = bucket * bucket_bits();
+	uint32_t tuple = sorted_tuples()[read_bits(bit, TUPLE_BITS)];
+	bit += TUPLE_BITS;
+	for (size_t slot = 0; slot < SLOTS_PER_BUCKET; ++slot) {
+		uint32_t high = (tuple >> (NIBBLE_BITS * (SLOTS_PER_BUCKET - 1 - slot))) & 0xf;
+		fingerprints[slot] = high << low_bits | read_bits(bit + slot * low_bits, low_bits);
+	}
+}
+
+void CuckooFilter::write_bucket(uint64_t bucket, uint32_t* fingerprints)
+{
+	// 按整个指纹排序，高4位也就单调不减；空槽（0）排在最前面
+	std::sort(fingerprints, fingerprints + SLOTS_PER_BUCKET);
+
+	size_t low_bits = m_fingerprint_bits - NIBBLE_BITS;
+	uint32_t tuple = 0;
+	for (size_t slot = 0; slot < SLOTS_PER_BUCKET; ++slot) tuple = tuple << NIBBLE_BITS | fingerprints[slot] >> low_bits;
+	const uint16_t* tuples = sorted_tuples();
+	uint32_t code = static_cast<uint32_t>(std::lower_bound(tuples, tuples + NUM_TUPLES, tuple) - tuples);
+
+	size_t first = bucket * bucket_bits();
+	write_bits(first, TUPLE_BITS, code);
+	for (size_t slot = 0; slot < SLOTS_PER_BUCKET; ++slot) {
+		write_bits(first + TUPLE_BITS + slot * low_bits, low_bits, fingerprints[slot]);
+	}
+	mark_dirty(first / 8, (first + bucket_bits() - 1) / 8);
+}
+
+uint32_t CuckooFilter::read_bits(size_t bit, size_t width) const
+{
+	uint64_t word;
+	std::memcpy(&word, m_table.data() + bit / 8, sizeof(word));
+	return static_cast<uint32_t>((word >> (bit % 8)) & ((1ULL << width) - 1));
+}
+
+void CuckooFilter::write_bits(size_t bit, size_t width, uint32_t value)
+{
+	uint64_t mask = ((1ULL << width) - 1) << (bit % 8);
+	uint64_t word;
+	std::memcpy(&word, m_table.data() + bit / 8, sizeof(word));
+	word = (word & ~mask) | ((static_cast<uint64_t>(value) << (bit % 8)) & mask);
+	std::memcpy(m_table.data() + bit / 8, &word, sizeof(word));
+}
+
+bool CuckooFilter::insert_into(uint64_t bucket, uint32_t fingerprint)
+{
+	uint32_t fingerprints[SLOTS_PER_BUCKET];
+	read_bucket(bucket, fingerprints);
+	for (size_t slot = 0; slot < SLOTS_PER_BUCKET; ++slot) {
+		if (fingerprints[slot] == 0) {
+			fingerprints[slot] = fingerprint;
+			write_bucket(bucket, fingerprints);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CuckooFilter::bucket_has(uint64_t bucket, uint32_t fingerprint) const
+{
+	uint32_t fingerprints[SLOTS_PER_BUCKET];
+	read_bucket(bucket, fingerprints);
+	for (size_t slot = 0; slot < SLOTS_PER_BUCKET; ++slot) {
+		if (fingerprints[slot] == fingerprint) return true;
+	}
+	return false;
+}
+
+bool CuckooFilter::erase_from(uint64_t bucket, uint32_t fingerprint)
+{
+	uint32_t fingerprints[SLOTS_PER_BUCKET];
+	read_bucket(bucket, fingerprints);
+	for (size_t slot = 0; slot < SLOTS_PER_BUCKET; ++slot) {
+		if (fingerprints[slot] == fingerprint) {
+			fingerprints[slot] = 0;
+			write_bucket(bucket, fingerprints);
+			return true;
+		}
+	}
+	return false;
+}
+
+uint64_t CuckooFilter::next_random()
+{
+	m_random ^= m_random << 13;
+	m_random ^= m_random >> 7;
+	m_random ^= m_random << 17;
+	return m_random;
+}
+
+void CuckooFilter::mark_dirty(size_t first_byte, size_t last_byte)
+{
+	for (size_t page = first_byte / PAGE_BYTES; page <= last_byte / PAGE_BYTES; ++page) {
+		m_dirty[page] = true;
+	}
+}
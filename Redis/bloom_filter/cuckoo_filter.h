@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <hiredis/hiredis.h>
+
+#include "murmur3.h"
+
+// 布谷鸟过滤器（cuckoo filter）：支持删除的近似成员查询，表放在本地内存中，持久化到Redis。
+//  - 表由n个桶组成，每桶4个槽，每个槽放一个f位的指纹（0表示空槽）
+//  - 半排序桶（semi-sorting）：桶内4个指纹按大小排列后，它们的高4位组成的有序四元组只有 C(19,4) = 3876 种，
+//    用12位的编号代替16位，每个桶占 4f - 4 位，每个指纹省1位。所有桶按位紧密排列，没有填充
+//  - 元素的指纹可以放在两个候选桶之一：i1由h1决定，i2 = (hash(指纹) - i1) mod n。由指纹和任意一个候选桶就能算出另一个，
+//    搬动指纹时不需要原始元素；n不必是2的幂，表的大小按预期元素数确定，不会浪费最多一半的空间
+//  - 误判率约为 2 * 4 / 2^f，f按目标误判率选取，装载率约95%，每个元素占用 (f - 1) / 0.95 位。
+//    目标为1%时f = 10，每个元素约9.5位，布隆过滤器约9.6位，实际误判率约0.75%；0.1%、0.01%时差距更大。
+//    并且可以删除元素，黑名单缩小时不需要重建
+//  - 只能删除确实添加过的元素，否则可能删掉别的元素的指纹而造成漏判；同一元素添加两次需要删除两次
+//
+// 持久化：表的原始字节保存在字符串 <key> 中（各字段按小端位序排列），参数、元素数和候选槽保存在哈希 <key>:meta 中。
+// save() 只写修改过的4KB页，所有SETRANGE和HSET放在一个MULTI/EXEC事务中，load() 同样在一个事务中读取，
+// 不会读到写了一半的表。Redis出错时抛出std::runtime_error，连接出错后下次使用时重新连接。
+class CuckooFilter {
+public:
+    static constexpr size_t SLOTS_PER_BUCKET = 4;
+    static constexpr size_t MAX_KICKS = 500;        // 一次添加最多搬动的指纹数
+    static constexpr size_t PAGE_BYTES = 4096;      // save() 跟踪修改的粒度
+
+    CuckooFilter(const std::string& redis_host, int redis_port,
+                 const std::string& key,
+                 const std::string& password = "",
+                 size_t expected_items = 10000,
+                 double false_positive_rate = 0.01);
+
+    ~CuckooFilter();
+
+    CuckooFilter(const CuckooFilter&) = delete;
+    CuckooFilter& operator=(const CuckooFilter&) = delete;
+
+    // 添加元素；表已满时返回false，元素没有加入
+    bool add(const std::string& element);
+
+    // 检查元素是否可能存在
+    bool contains(const std::string& element) const;
+
+    // 删除一个之前添加过的元素，返回是否找到了它的指纹
+    bool remove(const std::string& element);
+
+    // 清空本地的表（下次save时整体写入）
+    void clear();
+
+    // 从Redis读取表，Redis中没有数据时返回false；参数与当前过滤器不一致时抛出std::invalid_argument
+    bool load();
+
+    // 把修改过的页和元数据写入Redis
+    void save();
+
+    size_t size() const { return m_count; }
+    uint64_t num_buckets() const { return m_num_buckets; }
+    size_t fingerprint_bits() const { return m_fingerprint_bits; }
+    size_t bucket_bits() const { return SLOTS_PER_BUCKET * m_fingerprint_bits - SLOTS_PER_BUCKET; }
+    size_t table_bytes() const { return (m_num_buckets * bucket_bits() + 7) / 8; }
+    double load_factor() const { return static_cast<double>(m_count) / (m_num_buckets * SLOTS_PER_BUCKET); }
+
+    // 按当前装载率估计的误判率：一次查询比较两个桶中最多8个指纹
+    double false_positive_rate() const;
+
+    // 每个元素占用的位数
+    double bits_per_item() const;
+
+    // 获取过滤器的统计信息
+    void print_stats() const;
+
+private:
+    // 元素的指纹和两个候选桶
+    struct Candidates {
+        uint64_t i1;
+        uint64_t i2;
+        uint32_t fingerprint;
+    };
+
+    Candidates candidates(const std::string& element) const;
+
+    // 指纹的另一个候选桶，alt_index(alt_index(i, fp), fp) == i
+    uint64_t alt_index(uint64_t index, uint32_t fingerprint) const;
+
+    // 解码桶中的4个指纹 / 排序后编码写回
+    void read_bucket(uint64_t bucket, uint32_t* fingerprints) const;
+    void write_bucket(uint64_t bucket, uint32_t* fingerprints);
+
+    // 从第bit位开始按小端读写width位（width不超过32），一次读写8字节
+    uint32_t read_bits(size_t bit, size_t width) const;
+    void write_bits(size_t bit, size_t width, uint32_t value);
+
+    // 桶中的空槽放入指纹 / 桶中是否有指纹 / 删除桶中的一个指纹
+    bool insert_into(uint64_t bucket, uint32_t fingerprint);
+    bool bucket_has(uint64_t bucket, uint32_t fingerprint) const;
+    bool erase_from(uint64_t bucket, uint32_t fingerprint);
+
+    // 从index开始不断挤出并搬动指纹，直到找到空槽；搬动MAX_KICKS次仍未成功时，最后被挤出的指纹放到候选槽
+    void place(uint64_t index, uint32_t fingerprint);
+
+    // 搬动时随机选槽（xorshift64，结果可重现）
+    uint64_t next_random();
+
+    void mark_dirty(size_t first_byte, size_t last_byte);
+
+    // 返回可用的连接，上一次出错（超时、断开）后重新连接；重连失败时抛出std::runtime_error
+    redisContext* connection();
+
+    redisContext* m_redis_conn;             // Redis 连接
+    std::string m_redis_key;                // Redis 键名
+    const std::string m_redis_host;
+    const int m_redis_port;
+    const std::string m_redis_password;
+
+    uint64_t m_num_buckets;                 // 桶数
+    size_t m_fingerprint_bits;              // 指纹位数 f
+    uint32_t m_fingerprint_mask;
+    double m_target_false_positive_rate;    // 目标误判率
+
+    std::vector<uint8_t> m_table;           // 紧密排列的桶，末尾多8字节，读写字段时可以一次读写8字节
+    std::vector<bool> m_dirty;              // 每个4KB页是否修改过
+    size_t m_count;                         // 元素数
+
+    // 搬动MAX_KICKS次后仍然无处安放的指纹，有它时表已满
+    bool m_has_victim;
+    uint64_t m_victim_index;
+    uint32_t m_victim_fingerprint;
+
+    uint64_t m_random;
+};
@@ -0,0 +1,162 @@
+#include "local_bloom_filter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LOCAL_BLOOM_X86 1
+#endif
+
+using namespace std;
+using namespace blocked_bloom;
+
+// lane按主机字节序（小端）存放。Redis位序中lane内第b位在第b/8个字节的第7-b%8位，
+// 对应32位整数中的第 b ^ 7 位，这样内存中的字节与Redis字符串完全相同
+
+/**
+ * @brief 构造函数
+ *
+ * @param expected_items 预期存储的元素数量
+ * @param false_positive_rate 可接受的误判率 (0.01 表示 1%)
+ */
+LocalBloomFilter::LocalBloomFilter(size_t expected_items, double false_positive_rate)
+	:m_false_positive_rate(false_positive_rate)
+{
+	size_t num_blocks;
+	optimal_parameters(expected_items, false_positive_rate, num_blocks, m_num_hashes);
+	m_blocks.assign(num_blocks, Block{});
+
+	for (size_t first = 0; first < LANES; ++first) {
+		for (size_t lane = 0; lane < LANES; ++lane) {
+			m_lane_masks[first][lane] = (lane + LANES - first) % LANES < m_num_hashes ? 0xffffffffU : 0;
+		}
+	}
+
+	use_simd(true);
+}
+
+/**
+ * @brief 向布隆过滤器中添加元素
+ *
+ * @param element 要添加的元素
+ */
+void LocalBloomFilter::add(const std::string& element)
+{
+	Hash128 hash = murmur3_x64_128(element.data(), element.size());
+	Block& block = m_blocks[block_of(hash, m_blocks.size())];
+	if (m_simd) add_avx2(block, hash);
+	else add_scalar(block, hash);
+}
+
+/**
+ * @brief 检查元素是否可能存在于布隆过滤器中
+ *
+ * @param element 要检查的元素
+ * @return true 元素可能存在（可能有误判）
+ * @return false 元素绝对不存在
+ */
+bool LocalBloomFilter::contains(const std::string& element) const
+{
+	Hash128 hash = murmur3_x64_128(element.data(), element.size());
+	const Block& block = m_blocks[block_of(hash, m_blocks.size())];
+	if (m_simd) return contains_avx2(block, hash);
+	return contains_scalar(block, hash);
+}
+
+void LocalBloomFilter::clear()
+{
+	std::fill(m_blocks.begin(), m_blocks.end(), Block{});
+}
+
+/**
+ * @brief 选择AVX2或标量实现
+ *
+ * @param enable 为true且CPU支持AVX2时使用AVX2
+ */
+void LocalBloomFilter::use_simd(bool enable)
+{
+#ifdef LOCAL_BLOOM_X86
+	m_simd = enable && __builtin_cpu_supports("avx2");
+#else
+	(void)enable;
+	m_simd = false;
+#endif
+}
+
+void LocalBloomFilter::print_stats() const
+{
+	std::cout << "Local Bloom Filter Statistics:\n";
+	std::cout << "  Blocks: " << m_blocks.size() << " x " << BLOCK_BYTES << " bytes ("
+		<< (bitmap_bytes() / 1024.0) << " KB)\n";
+	std::cout << "  Number of hash functions: " << m_num_hashes << "\n";
+	std::cout << "  Expected false positive rate: " << (m_false_positive_rate * 100) << "%\n";
+	std::cout << "  Probe: " << (m_simd ? "AVX2" : "scalar") << "\n";
+}
+
+void LocalBloomFilter::add_scalar(Block& block, const Hash128& hash) const
+{
+	size_t first = first_lane(hash);
+	for (size_t i = 0; i < m_num_hashes; ++i) {
+		size_t lane = (first + i) % LANES;
+		block.lanes[lane] |= 1U << (bit_in_lane(hash, lane) ^ 7);
+	}
+}
+
+bool LocalBloomFilter::contains_scalar(const Block& block, const Hash128& hash) const
+{
+	size_t first = first_lane(hash);
+	for (size_t i = 0; i < m_num_hashes; ++i) {
+		size_t lane = (first + i) % LANES;
+		if ((block.lanes[lane] & (1U << (bit_in_lane(hash, lane) ^ 7))) == 0) return false;
+	}
+	return true;
+}
+
+#ifdef LOCAL_BLOOM_X86
+
+namespace {
+
+// 8个lane的掩码：每个lane中只有 (hash * salt) >> 27 对应的一位为1，不使用的lane为0
+__attribute__((target("avx2")))
+inline __m256i lane_masks(__m256i hash, const uint32_t* salts, const uint32_t* enabled)
+{
+	__m256i bits = _mm256_srli_epi32(_mm256_mullo_epi32(hash, _mm256_load_si256(reinterpret_cast<const __m256i*>(salts))), 27);
+	bits = _mm256_xor_si256(bits, _mm256_set1_epi32(7));
+	__m256i masks = _mm256_sllv_epi32(_mm256_set1_epi32(1), bits);
+	return _mm256_and_si256(masks, _mm256_load_si256(reinterpret_cast<const __m256i*>(enabled)));
+}
+
+}  // namespace
+
+__attribute__((target("avx2")))
+void LocalBloomFilter::add_avx2(Block& block, const Hash128& hash) const
+{
+	__m256i h = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(hash.h2)));
+	const uint32_t* enabled = m_lane_masks[first_lane(hash)];
+	__m256i* lanes = reinterpret_cast<__m256i*>(block.lanes);
+	for (size_t half = 0; half < 2; ++half) {
+		__m256i masks = lane_masks(h, SALTS + half * 8, enabled + half * 8);
+		_mm256_store_si256(lanes + half, _mm256_or_si256(_mm256_load_si256(lanes + half), masks));
+	}
+}
+
+__attribute__((target("avx2")))
+bool LocalBloomFilter::contains_avx2(const Block& block, const Hash128& hash) const
+{
+	__m256i h = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(hash.h2)));
+	const uint32_t* enabled = m_lane_masks[first_lane(hash)];
+	const __m256i* lanes = reinterpret_cast<const __m256i*>(block.lanes);
+	__m256i lo = lane_masks(h, SALTS, enabled);
+	__m256i hi = lane_masks(h, SALTS + 8, enabled + 8);
+	// testc: 掩码中的位在块中全部为1时返回1
+	return _mm256_testc_si256(_mm256_load_si256(lanes), lo) & _mm256_testc_si256(_mm256_load_si256(lanes + 1), hi);
+}
+
+#else
+
+void LocalBloomFilter::add_avx2(Block& block, const Hash128& hash) const { add_scalar(block, hash); }
+bool LocalBloomFilter::contains_avx2(const Block& block, const Hash128& hash) const { return contains_scalar(block, hash); }
+
+#endif
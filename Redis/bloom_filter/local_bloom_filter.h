@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "murmur3.h"
+
+// 分块布局（split block）：位图由64字节的块组成，每块分成16个32位的lane。
+// 元素用h1选一个块，再从h2的最高4位确定的起始lane开始，连续（循环）取k个lane，每个lane中放一个位，
+// lane j中的位置由h2的低32位乘以第j个盐值后取高5位。起始lane随元素变化，16个lane的填充率保持均匀。
+// 一个元素的全部k个位都在同一条缓存行里，查询只有一次缓存未命中；16个lane可以用两组AVX2指令并行计算。
+//
+// 位的编号与Redis的SETBIT/GETBIT/BITFIELD一致：第p位在第p/8个字节中，从最高位往最低位数。
+// 本地位图与Redis中的字符串逐字节相同，BloomFilter（BloomLayout::Blocked）可以直接用GETRANGE/SETRANGE整体导入导出。
+namespace blocked_bloom {
+
+constexpr size_t BLOCK_BYTES = 64;
+constexpr size_t BLOCK_BITS = BLOCK_BYTES * 8;
+constexpr size_t LANES = 16;
+constexpr size_t LANE_BITS = 32;
+constexpr size_t MAX_HASHES = LANES;    // 每个lane只放一个位
+
+// 奇数盐值，前8个与Parquet/Impala的split block布隆过滤器相同
+alignas(32) constexpr uint32_t SALTS[LANES] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+    0x9e3779b1U, 0x85ebca6bU, 0xc2b2ae35U, 0x27d4eb2fU, 0x165667b1U, 0xd3a2646dU, 0xfd7046c5U, 0xb55a4f09U,
+};
+
+inline size_t block_of(const Hash128& hash, size_t num_blocks)
+{
+    // 把h1映射到[0, num_blocks)，乘法取高位代替取模
+    return static_cast<size_t>((static_cast<unsigned __int128>(hash.h1) * num_blocks) >> 64);
+}
+
+// 元素使用的第一个lane，之后的lane依次为 (first + i) % LANES
+inline size_t first_lane(const Hash128& hash)
+{
+    return static_cast<size_t>(hash.h2 >> 60);
+}
+
+// 元素在第lane个lane中的位编号（0~31，按Redis位序）
+inline uint32_t bit_in_lane(const Hash128& hash, size_t lane)
+{
+    return (static_cast<uint32_t>(hash.h2) * SALTS[lane]) >> 27;
+}
+
+// 元素的k个位在整个位图中的位置（Redis的位偏移），Redis端的BloomFilter用它设置和读取
+inline void positions(const Hash128& hash, size_t num_blocks, size_t num_hashes, size_t* out)
+{
+    size_t base = block_of(hash, num_blocks) * BLOCK_BITS;
+    size_t first = first_lane(hash);
+    for (size_t i = 0; i < num_hashes; ++i) {
+        size_t lane = (first + i) % LANES;
+        out[i] = base + lane * LANE_BITS + bit_in_lane(hash, lane);
+    }
+}
+
+// 按expected_items和误判率计算块数和k，本地和Redis两端共用，保证参数一致
+inline void optimal_parameters(size_t expected_items, double false_positive_rate,
+                               size_t& num_blocks, size_t& num_hashes)
+{
+    double n = expected_items > 0 ? static_cast<double>(expected_items) : 1.0;
+    double bits = -(n * std::log(false_positive_rate)) / (std::log(2) * std::log(2));
+
+    num_blocks = static_cast<size_t>(std::ceil(bits / BLOCK_BITS));
+    if (num_blocks == 0) num_blocks = 1;
+
+    num_hashes = static_cast<size_t>(std::ceil(bits / n * std::log(2)));
+    if (num_hashes == 0) num_hashes = 1;
+    if (num_hashes > MAX_HASHES) num_hashes = MAX_HASHES;
+}
+
+}  // namespace blocked_bloom
+
+// 进程内的分块布隆过滤器，查询不访问网络。
+// 在支持AVX2的CPU上（运行时检测）用AVX2同时计算16个lane的掩码并一次比较，否则逐个lane的标量实现，两者结果完全相同。
+// 不是线程安全的：并发只读没有问题，写入需要调用方加锁。
+class LocalBloomFilter {
+public:
+    LocalBloomFilter(size_t expected_items = 10000, double false_positive_rate = 0.01);
+
+    // 向布隆过滤器中添加元素
+    void add(const std::string& element);
+
+    // 检查元素是否可能存在
+    bool contains(const std::string& element) const;
+
+    // 清空所有位
+    void clear();
+
+    // 是否使用AVX2；传入false强制使用标量实现（用于对比），CPU不支持时传入true也不会启用
+    void use_simd(bool enable);
+    bool simd() const { return m_simd; }
+
+    size_t num_blocks() const { return m_blocks.size(); }
+    size_t num_hashes() const { return m_num_hashes; }
+    size_t bitmap_bits() const { return m_blocks.size() * blocked_bloom::BLOCK_BITS; }
+    double false_positive_rate() const { return m_false_positive_rate; }
+
+    // 位图的原始字节（与Redis中的字符串格式相同），导入导出时使用
+    size_t bitmap_bytes() const { return m_blocks.size() * blocked_bloom::BLOCK_BYTES; }
+    const char* data() const { return reinterpret_cast<const char*>(m_blocks.data()); }
+    char* data() { return reinterpret_cast<char*>(m_blocks.data()); }
+
+    // 获取布隆过滤器的统计信息
+    void print_stats() const;
+
+private:
+    struct alignas(blocked_bloom::BLOCK_BYTES) Block {
+        uint32_t lanes[blocked_bloom::LANES];
+    };
+
+    void add_scalar(Block& block, const Hash128& hash) const;
+    bool contains_scalar(const Block& block, const Hash128& hash) const;
+    void add_avx2(Block& block, const Hash128& hash) const;
+    bool contains_avx2(const Block& block, const Hash128& hash) const;
+
+    std::vector<Block> m_blocks;
+    size_t m_num_hashes;                    // 哈希函数数量（使用的lane数）
+    double m_false_positive_rate;           // 误判率
+    bool m_simd;
+
+    // m_lane_masks[first]：从first开始的k个lane为全1，其余为0，AVX2用它屏蔽元素不使用的lane
+    alignas(32) uint32_t m_lane_masks[blocked_bloom::LANES][blocked_bloom::LANES];
+};
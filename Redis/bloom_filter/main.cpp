@@ -3,6 +3,7 @@
 #include <fstream>
 #include <cmath>
 #include <ctime>
+#include <unordered_set>
 
 #include "bloom_filter.h"
 
@@ -134,9 +135,11 @@ void simulate_email_processing(
 {
     // 将黑名单添加到布隆过滤器
     cout << "Adding " << blacklist.size() << " blacklisted emails to Bloom filter...\n";
-    for (const auto& email : blacklist) {
-        bloom_filter.add(email);
-    }
+    bloom_filter.add_many(blacklist);
+
+    // 所有邮件一次性流水线查询
+    vector<bool> detections = bloom_filter.contains_many(all_emails);
+    unordered_set<string> blacklist_set(blacklist.begin(), blacklist.end());
     
     // 打开统计文件
     ofstream stats_file(stats_filename);
@@ -156,12 +159,14 @@ void simulate_email_processing(
     size_t false_negatives = 0;
     
     // 处理每个邮件
-    for (const auto& email : all_emails) {
+    for (size_t i = 0; i < all_emails.size(); ++i) {
+        const string& email = all_emails[i];
+
         // 检查是否在黑名单中（实际）
-        bool is_blacklisted = find(blacklist.begin(), blacklist.end(), email) != blacklist.end();
+        bool is_blacklisted = blacklist_set.count(email) > 0;
         
-        // 使用布隆过滤器检测
-        bool detected = bloom_filter.searchKey(email);
+        // 布隆过滤器的检测结果
+        bool detected = detections[i];
         
         // 计算是否误判
         bool is_false_positive = !is_blacklisted && detected;
@@ -0,0 +1,293 @@
+#include "scalable_bloom_filter.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+redisContext* connect_redis_node(const string& host, int port, const string& password)
+{
+	struct timeval timeout = { 1, 500000 }; // 1.5 秒
+
+	redisOptions options;
+	memset(&options, 0, sizeof(redisOptions));
+	REDIS_OPTIONS_SET_TCP(&options, host.c_str(), port);
+	options.connect_timeout = &timeout;
+	options.command_timeout = &timeout;
+
+	redisContext* conn = redisConnectWithOptions(&options);
+	if (conn == nullptr) throw runtime_error("can not allocate redis context");
+	if (conn->err) {
+		string error = conn->errstr;
+		redisFree(conn);
+		throw runtime_error("connect " + host + ":" + to_string(port) + ": " + error);
+	}
+
+	if (!password.empty()) {
+		redisReply* reply = static_cast<redisReply*>(redisCommand(conn, "AUTH %b", password.data(), password.size()));
+		bool ok = reply != nullptr && reply->type != REDIS_REPLY_ERROR;
+		if (reply) freeReplyObject(reply);
+		if (!ok) {
+			redisFree(conn);
+			throw runtime_error("AUTH failed on " + host + ":" + to_string(port));
+		}
+	}
+	return conn;
+}
+
+}  // namespace
+
+/**
+ * @brief 构造函数
+ *
+ * @param key_prefix 各层键名和计数哈希的前缀
+ * @param initial_capacity 第0层的容量
+ * @param false_positive_rate 总误判率上界 (0.01 表示 1%)
+ * @param growth 每层容量是上一层的几倍，通常为2或4
+ * @param tightening 每层误判率是上一层的几倍，取值(0, 1)，通常为0.5到0.9
+ * @param layout 各层的位图布局
+ */
+ScalableBloomFilter::ScalableBloomFilter(const std::string& redis_host, int redis_port,
+	const std::string& key_prefix,
+	const std::string& password,
+	size_t initial_capacity,
+	double false_positive_rate,
+	double growth,
+	double tightening,
+	BloomLayout layout) :m_redis_conn(nullptr), m_redis_host(redis_host), m_redis_port(redis_port),
+	m_redis_password(password), m_key_prefix(key_prefix), m_initial_capacity(initial_capacity),
+	m_false_positive_rate(false_positive_rate), m_growth(growth), m_tightening(tightening), m_layout(layout)
+{
+	if (initial_capacity == 0) throw invalid_argument("initial_capacity must be positive");
+	if (growth < 1.0) throw invalid_argument("growth must be at least 1");
+	if (tightening <= 0.0 || tightening >= 1.0) throw invalid_argument("tightening must be in (0, 1)");
+
+	m_redis_conn = connect_redis_node(redis_host, redis_port, password);
+	try {
+		refresh();
+	} catch (...) {
+		redisFree(m_redis_conn);
+		throw;
+	}
+}
+
+ScalableBloomFilter::~ScalableBloomFilter()
+{
+	m_layers.clear();
+	if (m_redis_conn) {
+		redisFree(m_redis_conn);
+	}
+}
+
+/**
+ * @brief 向布隆过滤器中添加元素
+ *
+ * 先检查所有层，已经存在的元素不再占用最新一层的容量。写入最新一层后计数加1，达到容量时新建下一层；
+ * 多个进程同时新建时HSETNX只会成功一次
+ *
+ * @param element 要添加的元素
+ * @return true 元素是新加入的
+ * @return false 元素可能已经存在
+ */
+bool ScalableBloomFilter::add(const std::string& element)
+{
+	connection();
+	refresh_if_due();
+	if (contains_any(element)) return false;
+
+	size_t index = m_layers.size() - 1;
+	// 所有位原来都为1：其他进程刚刚加入了同一个元素，或者在最新一层中误判，都不计数
+	if (!m_layers[index]->add(element)) return false;
+
+	long long count = integer_command("HINCRBY", { counts_key(), to_string(index), "1" });
+	if (count >= static_cast<long long>(layer_capacity(index))) {
+		integer_command("HSETNX", { counts_key(), to_string(index + 1), "0" });
+		refresh();
+	}
+	return true;
+}
+
+/**
+ * @brief 检查元素是否可能存在于布隆过滤器中
+ *
+ * @param element 要检查的元素
+ * @return true 元素可能存在（可能有误判）
+ * @return false 元素绝对不存在
+ */
+bool ScalableBloomFilter::contains(const std::string& element)
+{
+	connection();
+	refresh_if_due();
+	return contains_any(element);
+}
+
+bool ScalableBloomFilter::contains_any(const std::string& element)
+{
+	for (size_t i = m_layers.size(); i-- > 0;) {
+		if (m_layers[i]->searchKey(element)) return true;
+	}
+	return false;
+}
+
+/**
+ * @brief 重新读取代号和层数（计数哈希的字段数），为新增的层建立BloomFilter
+ *
+ * 代号变化说明其他进程执行了clear()：删除本进程所知的旧一代的键（本进程之后不会再写入它们），换用新的一代。
+ * 各层借用m_redis_conn，建立新层不需要连接和认证
+ */
+void ScalableBloomFilter::refresh()
+{
+	long long generation = read_generation();
+	if (generation != m_generation) {
+		if (!m_layers.empty()) {
+			for (size_t i = 0; i < m_layers.size(); ++i) integer_command("DEL", { layer_key(i) });
+			integer_command("DEL", { counts_key() });
+		}
+		m_layers.clear();
+		m_generation = generation;
+		// 第0层总是存在；已经存在时不影响其他进程写入的计数
+		integer_command("HSETNX", { counts_key(), "0", "0" });
+	}
+
+	long long layers = integer_command("HLEN", { counts_key() });
+	for (size_t i = m_layers.size(); i < static_cast<size_t>(layers); ++i) {
+		m_layers.emplace_back(new BloomFilter(m_redis_conn, layer_key(i),
+			layer_capacity(i), layer_false_positive_rate(i), m_layout));
+	}
+	m_last_refresh = chrono::steady_clock::now();
+}
+
+void ScalableBloomFilter::refresh_if_due()
+{
+	if (chrono::steady_clock::now() - m_last_refresh >= REFRESH_INTERVAL) refresh();
+}
+
+/**
+ * @brief 开始新的一代
+ *
+ * 代号加1后refresh，删除旧一代的键并建立新的第0层。其他进程在下次refresh之前仍读写旧的一代，
+ * 这段时间内（最多REFRESH_INTERVAL）它们加入的元素在新的一代中看不到
+ */
+void ScalableBloomFilter::clear()
+{
+	integer_command("INCR", { generation_key() });
+	refresh();
+}
+
+/**
+ * @brief 第index层的容量 initial_capacity * growth^index
+ */
+size_t ScalableBloomFilter::layer_capacity(size_t index) const
+{
+	return static_cast<size_t>(std::ceil(m_initial_capacity * std::pow(m_growth, static_cast<double>(index))));
+}
+
+/**
+ * @brief 第index层的误判率 p * (1 - r) * r^index，所有层加起来小于p
+ */
+double ScalableBloomFilter::layer_false_positive_rate(size_t index) const
+{
+	return m_false_positive_rate * (1.0 - m_tightening) * std::pow(m_tightening, static_cast<double>(index));
+}
+
+/**
+ * @brief 按各层实际的填充率估计误判率
+ *
+ * 一个不存在的元素在第i层被误判的概率约为 fill_i^k_i，任意一层误判都算误判
+ */
+double ScalableBloomFilter::estimated_false_positive_rate()
+{
+	connection();
+	double pass = 1.0;
+	for (auto& layer : m_layers) {
+		pass *= 1.0 - std::pow(layer->fill_ratio(), static_cast<double>(layer->num_hashes()));
+	}
+	return 1.0 - pass;
+}
+
+/**
+ * @brief 返回可用的连接；连接出错后hiredis的上下文不能再使用，重新连接并交给各层
+ */
+redisContext* ScalableBloomFilter::connection()
+{
+	if (m_redis_conn->err) {
+		redisContext* fresh = connect_redis_node(m_redis_host, m_redis_port, m_redis_password);
+		redisFree(m_redis_conn);
+		m_redis_conn = fresh;
+		for (auto& layer : m_layers) layer->attach(m_redis_conn);
+	}
+	return m_redis_conn;
+}
+
+long long ScalableBloomFilter::read_generation()
+{
+	string key = generation_key();
+	redisReply* reply = static_cast<redisReply*>(redisCommand(connection(), "GET %b", key.data(), key.size()));
+	if (reply == nullptr) throw runtime_error("GET failed: " + string(m_redis_conn->errstr));
+	if (reply->type == REDIS_REPLY_ERROR) {
+		string error = reply->str;
+		freeReplyObject(reply);
+		throw runtime_error("GET failed: " + error);
+	}
+	long long generation = reply->type == REDIS_REPLY_STRING ? stoll(string(reply->str, reply->len)) : 0;
+	freeReplyObject(reply);
+	return generation;
+}
+
+long long ScalableBloomFilter::layer_count(size_t index)
+{
+	string field = to_string(index);
+	string key = counts_key();
+	redisReply* reply = static_cast<redisReply*>(redisCommand(connection(), "HGET %b %b",
+		key.data(), key.size(), field.data(), field.size()));
+	if (reply == nullptr) throw runtime_error("HGET failed: " + string(m_redis_conn->errstr));
+	long long count = reply->type == REDIS_REPLY_STRING ? stoll(string(reply->str, reply->len)) : 0;
+	freeReplyObject(reply);
+	return count;
+}
+
+/**
+ * @brief 执行一条返回整数的命令
+ */
+long long ScalableBloomFilter::integer_command(const char* name, const std::vector<std::string>& args)
+{
+	vector<const char*> argv = { name };
+	vector<size_t> argvlen = { strlen(name) };
+	for (const string& arg : args) {
+		argv.push_back(arg.data());
+		argvlen.push_back(arg.size());
+	}
+
+	redisReply* reply = static_cast<redisReply*>(redisCommandArgv(connection(),
+		static_cast<int>(argv.size()), argv.data(), argvlen.data()));
+	if (reply == nullptr) throw runtime_error(string(name) + " failed: " + m_redis_conn->errstr);
+	if (reply->type != REDIS_REPLY_INTEGER) {
+		string error = reply->type == REDIS_REPLY_ERROR ? reply->str : "unexpected reply";
+		freeReplyObject(reply);
+		throw runtime_error(string(name) + " failed: " + error);
+	}
+	long long value = reply->integer;
+	freeReplyObject(reply);
+	return value;
+}
+
+/**
+ * @brief 获取布隆过滤器的统计信息
+ */
+void ScalableBloomFilter::print_stats()
+{
+	std::cout << "Scalable Bloom Filter Statistics:\n";
+	std::cout << "  Layers: " << m_layers.size() << " (growth " << m_growth << ", tightening " << m_tightening << ")\n";
+	std::cout << "  False positive rate bound: " << (m_false_positive_rate * 100) << "%\n";
+	for (size_t i = 0; i < m_layers.size(); ++i) {
+		BloomFilter& layer = *m_layers[i];
+		std::cout << "  Layer " << i << ": " << layer_count(i) << " / " << layer_capacity(i) << " items, "
+			<< (layer.bitmap_bits() / 8 / 1024.0) << " KB, k = " << layer.num_hashes()
+			<< ", fp " << (layer.false_positive_rate() * 100) << "%, fill ratio " << (layer.fill_ratio() * 100) << "%\n";
+	}
+	std::cout << "  Estimated false positive rate: " << (estimated_false_positive_rate() * 100) << "%\n";
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <hiredis/hiredis.h>
+
+#include "bloom_filter.h"
+
+// 可扩展布隆过滤器（Scalable Bloom Filter）：由若干层BloomFilter组成，元素数超过预期时新建一层，而不是让误判率一直上升。
+//  - 第i层的键为 <key_prefix>:<代>:<i>，容量为 initial_capacity * growth^i，误判率为 p * (1 - r) * r^i（r为tightening），
+//    各层误判率之和小于p，总的误判率有上界
+//  - 元素只写入最新的一层，最新一层的元素数达到容量时新建下一层
+//  - 各层的元素数保存在哈希 <key_prefix>:<代>:counts 中（字段为层号），多个进程共享同一组层，层数即哈希的字段数
+//  - 代号保存在 <key_prefix>:generation 中，clear() 把它加1，各进程refresh时发现代号变化就换用新的一代。
+//    还没发现的进程只会写旧一代的键，不会改动新一代的层数；旧一代的键由发现代号变化的进程删除
+//  - 查询从最新的一层开始，近期加入的元素大多在最新的层中
+// Redis出错时抛出std::runtime_error。
+class ScalableBloomFilter {
+public:
+    // 多久重新读取一次层数，其他进程新建的层在这之后可见
+    static constexpr std::chrono::milliseconds REFRESH_INTERVAL{1000};
+
+    ScalableBloomFilter(const std::string& redis_host, int redis_port,
+                        const std::string& key_prefix,
+                        const std::string& password = "",
+                        size_t initial_capacity = 10000,
+                        double false_positive_rate = 0.01,
+                        double growth = 2.0,
+                        double tightening = 0.5,
+                        BloomLayout layout = BloomLayout::Standard);
+
+    ~ScalableBloomFilter();
+
+    ScalableBloomFilter(const ScalableBloomFilter&) = delete;
+    ScalableBloomFilter& operator=(const ScalableBloomFilter&) = delete;
+
+    // 添加元素；已经存在（或被误判为存在）时不写入，返回false
+    bool add(const std::string& element);
+
+    // 检查元素是否可能存在于布隆过滤器中
+    bool contains(const std::string& element);
+
+    // 重新读取层数，打开其他进程新建的层
+    void refresh();
+
+    // 开始新的一代，回到只有第0层的状态，并删除旧一代的层和计数
+    void clear();
+
+    size_t num_layers() const { return m_layers.size(); }
+    size_t layer_capacity(size_t index) const;
+    double layer_false_positive_rate(size_t index) const;
+
+    // 按各层的填充率估计当前的误判率：1 - ∏(1 - fill_i^k_i)
+    double estimated_false_positive_rate();
+
+    // 获取布隆过滤器的统计信息，包括每一层的元素数和填充率
+    void print_stats();
+
+private:
+    // 元素不在任何一层时返回false，从最新的一层开始查
+    bool contains_any(const std::string& element);
+
+    // 距离上次读取层数超过REFRESH_INTERVAL时重新读取
+    void refresh_if_due();
+
+    // 计数和各层共用的连接，断开后重新连接并交给各层
+    redisContext* connection();
+
+    // 第index层的元素数
+    long long layer_count(size_t index);
+
+    // 执行一条返回整数的命令
+    long long integer_command(const char* name, const std::vector<std::string>& args);
+
+    // 读取当前的代号，还没有clear过时为0
+    long long read_generation();
+
+    std::string generation_key() const { return m_key_prefix + ":generation"; }
+    std::string counts_key() const { return m_key_prefix + ":" + std::to_string(m_generation) + ":counts"; }
+    std::string layer_key(size_t index) const {
+        return m_key_prefix + ":" + std::to_string(m_generation) + ":" + std::to_string(index);
+    }
+
+    redisContext* m_redis_conn;             // 读写计数的连接，各层借用同一条连接
+    const std::string m_redis_host;
+    const int m_redis_port;
+    const std::string m_redis_password;
+    const std::string m_key_prefix;
+
+    size_t m_initial_capacity;              // 第0层的容量
+    double m_false_positive_rate;           // 总误判率上界
+    double m_growth;                        // 每层容量的增长倍数
+    double m_tightening;                    // 每层误判率的收紧比例
+    BloomLayout m_layout;
+
+    long long m_generation = -1;            // 当前使用的代号，-1表示还没有读取
+    std::vector<std::unique_ptr<BloomFilter>> m_layers;
+    std::chrono::steady_clock::time_point m_last_refresh;
+};
@@ -0,0 +1,333 @@
+#include "sharded_bloom_filter.h"
+
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+using namespace blocked_bloom;
+
+namespace {
+
+redisContext* connect_node(const RedisNode& node)
+{
+	struct timeval timeout = { 1, 500000 }; // 1.5 秒
+
+	redisOptions options;
+	memset(&options, 0, sizeof(redisOptions));
+	REDIS_OPTIONS_SET_TCP(&options, node.host.c_str(), node.port);
+	options.connect_timeout = &timeout;
+	options.command_timeout = &timeout;
+
+	redisContext* conn = redisConnectWithOptions(&options);
+	if (conn == nullptr) throw runtime_error("can not allocate redis context");
+	if (conn->err) {
+		string error = conn->errstr;
+		redisFree(conn);
+		throw runtime_error("connect " + node.host + ":" + to_string(node.port) + ": " + error);
+	}
+
+	if (!node.password.empty()) {
+		redisReply* reply = static_cast<redisReply*>(redisCommand(conn, "AUTH %b", node.password.data(), node.password.size()));
+		bool ok = reply != nullptr && reply->type != REDIS_REPLY_ERROR;
+		if (reply) freeReplyObject(reply);
+		if (!ok) {
+			redisFree(conn);
+			throw runtime_error("AUTH failed on " + node.host + ":" + to_string(node.port));
+		}
+	}
+
+	// 分片按编号放在固定的节点上，cluster节点会对大部分分片返回MOVED，直接拒绝。
+	// INFO被禁用时返回错误，按单机处理
+	redisReply* reply = static_cast<redisReply*>(redisCommand(conn, "INFO cluster"));
+	bool cluster = reply != nullptr && reply->type == REDIS_REPLY_STRING && strstr(reply->str, "cluster_enabled:1") != nullptr;
+	if (reply) freeReplyObject(reply);
+	if (cluster) {
+		redisFree(conn);
+		throw runtime_error(node.host + ":" + to_string(node.port) + " is a Redis Cluster node, ShardedBloomFilter needs standalone nodes");
+	}
+	return conn;
+}
+
+}  // namespace
+
+/**
+ * @brief 构造函数
+ *
+ * @param nodes 独立的单机Redis节点，分片按编号轮流放在各个节点上
+ * @param key_prefix 分片键名前缀
+ * @param expected_items 预期存储的元素数量
+ * @param false_positive_rate 可接受的误判率 (0.01 表示 1%)
+ * @param shard_bytes 每个分片的字节数，必须是64的倍数且不超过512MB
+ */
+ShardedBloomFilter::ShardedBloomFilter(const std::vector<RedisNode>& nodes,
+	const std::string& key_prefix,
+	uint64_t expected_items,
+	double false_positive_rate,
+	uint64_t shard_bytes) :m_nodes(nodes), m_key_prefix(key_prefix), m_false_positive_rate(false_positive_rate)
+{
+	if (nodes.empty()) throw invalid_argument("ShardedBloomFilter needs at least one node");
+	if (shard_bytes == 0 || shard_bytes % BLOCK_BYTES != 0 || shard_bytes > (512ULL << 20)) {
+		throw invalid_argument("shard_bytes must be a positive multiple of 64 and at most 512MB");
+	}
+
+	size_t num_blocks;
+	optimal_parameters(expected_items, false_positive_rate, num_blocks, m_num_hashes);
+	m_num_blocks = num_blocks;
+	m_blocks_per_shard = shard_bytes / BLOCK_BYTES;
+	m_num_shards = (m_num_blocks + m_blocks_per_shard - 1) / m_blocks_per_shard;
+
+	try {
+		for (const RedisNode& node : nodes) m_conns.push_back(connect_node(node));
+	} catch (...) {
+		for (redisContext* conn : m_conns) redisFree(conn);
+		throw;
+	}
+}
+
+ShardedBloomFilter::~ShardedBloomFilter()
+{
+	for (redisContext* conn : m_conns) {
+		if (conn) redisFree(conn);
+	}
+}
+
+redisContext* ShardedBloomFilter::connection(size_t node)
+{
+	// hiredis的上下文出错后不能再使用
+	if (m_conns[node] != nullptr && m_conns[node]->err) drop_connection(node);
+	if (m_conns[node] == nullptr) m_conns[node] = connect_node(m_nodes[node]);
+	return m_conns[node];
+}
+
+void ShardedBloomFilter::drop_connection(size_t node)
+{
+	if (m_conns[node]) {
+		redisFree(m_conns[node]);
+		m_conns[node] = nullptr;
+	}
+}
+
+/**
+ * @brief 向布隆过滤器中添加元素
+ *
+ * @param element 要添加的元素
+ */
+void ShardedBloomFilter::add(const std::string& element)
+{
+	read_bitfield_reply(append_bitfield(element, true));
+}
+
+/**
+ * @brief 检查元素是否可能存在于布隆过滤器中
+ *
+ * @param element 要检查的元素
+ * @return true 元素可能存在（可能有误判）
+ * @return false 元素绝对不存在
+ */
+bool ShardedBloomFilter::contains(const std::string& element)
+{
+	return read_bitfield_reply(append_bitfield(element, false));
+}
+
+void ShardedBloomFilter::add_many(const std::vector<std::string>& elements, size_t window)
+{
+	pipeline(elements, true, window, [](size_t, bool) {});
+}
+
+std::vector<bool> ShardedBloomFilter::contains_many(const std::vector<std::string>& elements, size_t window)
+{
+	vector<bool> result(elements.size(), false);
+	pipeline(elements, false, window, [&](size_t index, bool found) { result[index] = found; });
+	return result;
+}
+
+/**
+ * @brief 删除所有分片键（UNLINK，在Redis后台线程中释放内存）
+ *
+ * 出错后不再发送，读完各节点已发出命令的回复再抛出
+ */
+void ShardedBloomFilter::clear()
+{
+	vector<size_t> pending(m_conns.size(), 0);
+	string error;
+
+	for (uint64_t shard = 0; shard < m_num_shards && error.empty(); ++shard) {
+		size_t node = node_of(shard);
+		string key = shard_key(shard);
+		try {
+			if (redisAppendCommand(connection(node), "UNLINK %b", key.data(), key.size()) != REDIS_OK) {
+				error = "UNLINK failed: " + string(m_conns[node]->errstr);
+				drop_connection(node);
+				pending[node] = 0;
+				break;
+			}
+			++pending[node];
+		} catch (const runtime_error& e) {
+			error = e.what();
+		}
+	}
+
+	for (size_t node = 0; node < m_conns.size(); ++node) {
+		for (; pending[node] > 0; --pending[node]) {
+			void* raw = nullptr;
+			if (redisGetReply(m_conns[node], &raw) != REDIS_OK || raw == nullptr) {
+				if (error.empty()) error = "UNLINK failed: " + string(m_conns[node]->errstr);
+				drop_connection(node);
+				break;
+			}
+			redisReply* reply = static_cast<redisReply*>(raw);
+			if (reply->type == REDIS_REPLY_ERROR && error.empty()) error = "UNLINK failed: " + string(reply->str);
+			freeReplyObject(reply);
+		}
+	}
+
+	if (!error.empty()) throw runtime_error(error);
+}
+
+void ShardedBloomFilter::print_stats() const
+{
+	std::cout << "Sharded Bloom Filter Statistics:\n";
+	std::cout << "  Bitmap size: " << bitmap_bits() << " bits ("
+		<< (bitmap_bits() / 8.0 / (1024 * 1024)) << " MB)\n";
+	std::cout << "  Shards: " << m_num_shards << " x " << (m_blocks_per_shard * BLOCK_BYTES / 1024.0) << " KB on "
+		<< m_conns.size() << " node(s)\n";
+	std::cout << "  Number of hash functions: " << m_num_hashes << "\n";
+	std::cout << "  Expected false positive rate: " << (m_false_positive_rate * 100) << "%\n";
+}
+
+/**
+ * @brief 计算元素所在的分片和k个位在分片内的偏移
+ *
+ * 先在整个逻辑位图中选块（64位），块号除以每片块数得到分片，余数是分片内的块
+ */
+ShardedBloomFilter::Location ShardedBloomFilter::locate(const std::string& element) const
+{
+	Hash128 hash = murmur3_x64_128(element.data(), element.size());
+	uint64_t block = block_of(hash, m_num_blocks);
+
+	Location loc;
+	loc.shard = block / m_blocks_per_shard;
+	uint64_t base = (block % m_blocks_per_shard) * BLOCK_BITS;
+	size_t first = first_lane(hash);
+	for (size_t i = 0; i < m_num_hashes; ++i) {
+		size_t lane = (first + i) % LANES;
+		loc.offsets[i] = base + lane * LANE_BITS + bit_in_lane(hash, lane);
+	}
+	return loc;
+}
+
+/**
+ * @brief 追加一条BITFIELD命令到元素所在节点的输出缓冲
+ *
+ * @return 节点下标
+ */
+size_t ShardedBloomFilter::append_bitfield(const std::string& element, bool set)
+{
+	Location loc = locate(element);
+	string key = shard_key(loc.shard);
+
+	vector<string> args = { "BITFIELD", key };
+	args.reserve(2 + m_num_hashes * (set ? 4 : 3));
+	for (size_t i = 0; i < m_num_hashes; ++i) {
+		args.push_back(set ? "SET" : "GET");
+		args.push_back("u1");
+		args.push_back(to_string(loc.offsets[i]));
+		if (set) args.push_back("1");
+	}
+
+	vector<const char*> argv;
+	vector<size_t> argvlen;
+	for (const string& arg : args) {
+		argv.push_back(arg.data());
+		argvlen.push_back(arg.size());
+	}
+
+	size_t node = node_of(loc.shard);
+	redisContext* conn = connection(node);
+	if (redisAppendCommandArgv(conn, static_cast<int>(argv.size()), argv.data(), argvlen.data()) != REDIS_OK) {
+		string error = conn->errstr;
+		drop_connection(node);
+		throw runtime_error("BITFIELD failed: " + error);
+	}
+	return node;
+}
+
+/**
+ * @brief 读取一条BITFIELD回复
+ *
+ * @return k个位（设置时为设置前的旧值）是否全为1
+ */
+bool ShardedBloomFilter::read_bitfield_reply(size_t node)
+{
+	void* raw = nullptr;
+	if (redisGetReply(m_conns[node], &raw) != REDIS_OK || raw == nullptr) {
+		string error = m_conns[node]->errstr;
+		drop_connection(node);
+		throw runtime_error("BITFIELD failed: " + error);
+	}
+
+	redisReply* reply = static_cast<redisReply*>(raw);
+	if (reply->type != REDIS_REPLY_ARRAY) {
+		string error = reply->type == REDIS_REPLY_ERROR ? reply->str : "unexpected reply";
+		freeReplyObject(reply);
+		throw runtime_error("BITFIELD failed: " + error);
+	}
+
+	bool all_set = true;
+	for (size_t i = 0; i < reply->elements; ++i) {
+		if (reply->element[i]->integer == 0) {
+			all_set = false;
+			break;
+		}
+	}
+	freeReplyObject(reply);
+	return all_set;
+}
+
+/**
+ * @brief 批量发送BITFIELD命令
+ *
+ * 每个节点的回复按发送顺序返回，各节点记录自己在途的元素下标；某个节点在途命令达到window条时先读它最早的一条回复。
+ * 最后读完所有节点剩余的回复。
+ *
+ * 出错后不再发送新命令，但仍读完各节点在途的回复再抛出，连接上不会留下未读的回复；
+ * 连接出错的节点已被丢弃，它在途的回复不再读取
+ */
+template<typename F>
+void ShardedBloomFilter::pipeline(const std::vector<std::string>& elements, bool set, size_t window, F&& on_result)
+{
+	if (window == 0) window = 1;
+	vector<deque<size_t>> inflight(m_conns.size());
+	string error;
+
+	auto take = [&](size_t node) {
+		size_t index = inflight[node].front();
+		inflight[node].pop_front();
+		try {
+			on_result(index, read_bitfield_reply(node));
+		} catch (const runtime_error& e) {
+			if (error.empty()) error = e.what();
+			if (m_conns[node] == nullptr) inflight[node].clear();
+		}
+	};
+
+	for (size_t i = 0; i < elements.size() && error.empty(); ++i) {
+		size_t node;
+		try {
+			node = append_bitfield(elements[i], set);
+		} catch (const runtime_error& e) {
+			error = e.what();
+			break;
+		}
+		inflight[node].push_back(i);
+		if (inflight[node].size() >= window) take(node);
+	}
+
+	for (size_t node = 0; node < m_conns.size(); ++node) {
+		while (!inflight[node].empty()) take(node);
+	}
+
+	if (!error.empty()) throw runtime_error(error);
+}
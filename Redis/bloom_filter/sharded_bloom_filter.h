@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <hiredis/hiredis.h>
+
+#include "local_bloom_filter.h"
+
+// 一个Redis节点
+struct RedisNode {
+    std::string host;
+    int port = 6379;
+    std::string password;
+};
+
+// 分片布隆过滤器：逻辑上是一个分块布局（见local_bloom_filter.h）的大位图，按连续的块切成多个分片，
+// 每个分片是一个独立的Redis键 <key_prefix>:<分片号>，分片i放在nodes[i % nodes.size()]上。
+//  - 块号、位偏移全部用64位计算，总位数不受单个Redis字符串512MB（2^32位）的限制，可以容纳数十亿元素
+//  - 元素的k个位在同一个块中，也就在同一个分片中，每个元素只需要一条BITFIELD命令
+//  - 分片大小可配置，单个键不会过大，避免大key在迁移、删除、持久化时阻塞Redis
+// 节点必须是互相独立的单机Redis（或各自的主从），分片按编号固定放置，不按Redis Cluster的slot路由，
+// 也不处理MOVED重定向；连接到开启了cluster模式的节点时构造函数抛出std::runtime_error。
+// 所有使用同一个key_prefix的进程必须以相同的顺序给出相同的节点列表。
+// Redis出错时抛出std::runtime_error；抛出之前读完所有节点上在途的回复，连接出错的节点在下次使用时重新连接。
+class ShardedBloomFilter {
+public:
+    static constexpr uint64_t DEFAULT_SHARD_BYTES = 64ULL << 20;   // 64MB，即2^29位
+
+    ShardedBloomFilter(const std::vector<RedisNode>& nodes,
+                       const std::string& key_prefix,
+                       uint64_t expected_items,
+                       double false_positive_rate = 0.01,
+                       uint64_t shard_bytes = DEFAULT_SHARD_BYTES);
+
+    ~ShardedBloomFilter();
+
+    ShardedBloomFilter(const ShardedBloomFilter&) = delete;
+    ShardedBloomFilter& operator=(const ShardedBloomFilter&) = delete;
+
+    // 向布隆过滤器中添加元素
+    void add(const std::string& element);
+
+    // 检查元素是否可能存在于布隆过滤器中
+    bool contains(const std::string& element);
+
+    // 批量添加/检查：按节点分组流水线发送，每个节点最多window条命令在途
+    void add_many(const std::vector<std::string>& elements, size_t window = 1024);
+    std::vector<bool> contains_many(const std::vector<std::string>& elements, size_t window = 1024);
+
+    // 删除所有分片键
+    void clear();
+
+    uint64_t num_shards() const { return m_num_shards; }
+    uint64_t blocks_per_shard() const { return m_blocks_per_shard; }
+    uint64_t bitmap_bits() const { return m_num_blocks * blocked_bloom::BLOCK_BITS; }
+    size_t num_hashes() const { return m_num_hashes; }
+    std::string shard_key(uint64_t shard) const { return m_key_prefix + ":" + std::to_string(shard); }
+
+    // 获取布隆过滤器的统计信息
+    void print_stats() const;
+
+private:
+    // 元素落在哪个分片，以及k个位在分片内的位偏移
+    struct Location {
+        uint64_t shard;
+        uint64_t offsets[blocked_bloom::MAX_HASHES];
+    };
+
+    Location locate(const std::string& element) const;
+
+    size_t node_of(uint64_t shard) const { return shard % m_conns.size(); }
+
+    // 节点的连接，断开后重新连接；重连失败时抛出std::runtime_error
+    redisContext* connection(size_t node);
+
+    // 丢弃出错的连接，未读的回复随之丢弃
+    void drop_connection(size_t node);
+
+    // 把元素的BITFIELD命令追加到所在节点的输出缓冲，返回节点下标
+    size_t append_bitfield(const std::string& element, bool set);
+
+    // 从节点读取一条BITFIELD回复，返回k个位是否全为1；连接出错时先丢弃连接再抛出
+    bool read_bitfield_reply(size_t node);
+
+    // 批量操作的公共部分，on_result(下标, 是否全为1)
+    template<typename F>
+    void pipeline(const std::vector<std::string>& elements, bool set, size_t window, F&& on_result);
+
+    std::vector<RedisNode> m_nodes;         // 节点地址，重新连接时使用
+    std::vector<redisContext*> m_conns;     // 每个节点一条连接，nullptr表示已断开
+    std::string m_key_prefix;               // 分片键名前缀
+
+    uint64_t m_num_blocks;                  // 整个逻辑位图的块数
+    uint64_t m_blocks_per_shard;            // 每个分片的块数
+    uint64_t m_num_shards;                  // 分片数
+    size_t m_num_hashes;                    // 哈希函数数量
+    double m_false_positive_rate;           // 误判率
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// 缓存默认使用的哈希与判等。std::string的key支持透明查找：
+// 可以直接用std::string_view / const char* 查询，不需要先构造一个临时的std::string。
+template<typename K>
+struct CacheHash : std::hash<K> {};
+
+template<>
+struct CacheHash<std::string> {
+    using is_transparent = void;
+    // std::hash<std::string>与std::hash<std::string_view>对相同内容的结果一致
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>()(s); }
+};
+
+template<typename K>
+using CacheKeyEqual = std::conditional_t<std::is_same_v<K, std::string>, std::equal_to<>, std::equal_to<K>>;
+
+template<typename T, typename = void>
+struct cache_is_transparent : std::false_type {};
+
+template<typename T>
+struct cache_is_transparent<T, std::void_t<typename T::is_transparent>> : std::true_type {};
+
+// 用任意可与K比较的类型Q在哈希表中查找。
+// 标准库支持异构查找（C++20）且哈希、判等都是透明的时候直接查；否则构造一个临时K。
+template<typename Map, typename Q>
+auto cache_find(Map& map, const Q& key)
+{
+    using M = std::remove_const_t<Map>;
+    using K = typename M::key_type;
+
+    if constexpr (std::is_same_v<Q, K>) {
+        return map.find(key);
+    }
+#if defined(__cpp_lib_generic_unordered_lookup) && __cpp_lib_generic_unordered_lookup >= 201811L
+    else if constexpr (cache_is_transparent<typename M::hasher>::value &&
+                       cache_is_transparent<typename M::key_equal>::value) {
+        return map.find(key);
+    }
+#endif
+    else {
+        return map.find(K(key));
+    }
+}
+
+// 预取一个地址所在的缓存行，批量接口用它让多个key的内存访问互相重叠
+inline void cache_prefetch(const void* addr)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(addr);
+#else
+    (void)addr;
+#endif
+}
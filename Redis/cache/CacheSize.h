@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+// 估算单个对象占用的字节数（对象本身 + 它拥有的堆内存），可针对自定义类型特化。
+// 估算值只能依赖对象的逻辑内容，同一个值无论何时计算都要得到相同结果
+template<typename T>
+struct SizeEstimator {
+    size_t operator()(const T&) const { return sizeof(T); }
+};
+
+template<typename C, typename T, typename A>
+struct SizeEstimator<std::basic_string<C, T, A>> {
+    size_t operator()(const std::basic_string<C, T, A>& s) const
+    {
+        // 短字符串存放在对象内部（SSO），超出后才有堆分配。
+        // 按size()而不是capacity()估算：拷贝赋值会保留旧的capacity，按capacity计费会前后不一致
+        size_t heap = s.size() > SSO_CAPACITY ? (s.size() + 1) * sizeof(C) : 0;
+        return sizeof(s) + heap;
+    }
+    static constexpr size_t SSO_CAPACITY = 15 / sizeof(C);
+};
+
+template<typename T, typename A>
+struct SizeEstimator<std::vector<T, A>> {
+    size_t operator()(const std::vector<T, A>& v) const
+    {
+        // 平凡类型的元素没有额外的堆内存，不用逐个累加
+        if constexpr (std::is_trivially_copyable_v<T>) return sizeof(v) + v.size() * sizeof(T);
+
+        size_t bytes = sizeof(v);
+        SizeEstimator<T> element;
+        for (const auto& item : v) bytes += element(item);
+        return bytes;
+    }
+};
+
+// 按条目计数：每个条目记1，capacity就是最大条目数（默认行为）
+struct EntryCount {
+    template<typename K, typename V>
+    size_t operator()(const K&, const V&) const { return 1; }
+};
+
+// 按字节计数：capacity是字节预算，每个条目按 key + value + 节点开销 计费
+struct ByteSize {
+    // 链表节点的前后指针、过期时间和定时器句柄 + 哈希表节点的next指针、迭代器、缓存的哈希值和桶指针
+    static constexpr size_t ENTRY_OVERHEAD = 8 * sizeof(void*);
+
+    template<typename K, typename V>
+    size_t operator()(const K& key, const V& value) const
+    {
+        return ENTRY_OVERHEAD + SizeEstimator<K>()(key) + SizeEstimator<V>()(value);
+    }
+};
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <chrono>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 缓存快照的文件格式与读写工具，LRUCache/LFUCache的save()/load()使用。
+//
+// 文件布局（本机字节序，字段之间没有填充）：
+//   header: magic "LYCSNAP1"(8) | byte_order(4) | kind(4) | version(4) | key_type(4) | value_type(4) | count(8)
+//   LRU条目（从最旧到最新）:               expire(8) | key | value
+//   LFU条目（频率升序，同频率从最旧到最新）: freq(8) | expire(8) | key | value
+// expire是Unix毫秒时间戳，0表示永不过期；按绝对时间保存，重启期间到期的条目加载时直接跳过。
+// 按这个顺序依次插入即可恢复原来的访问顺序和频率：先插入的旧条目在容量不足时先被淘汰。
+// key_type/value_type是类型标记（类别 << 16 | sizeof），用不同的K、V加载时抛出异常，而不是把字节解释成错误的类型。
+// 平凡可拷贝的key/value按内存原样写入，无法统一转换字节序，所以整个文件使用本机字节序：
+// byte_order是按本机字节序写入的0x01020304，在字节序不同的机器上读到的值不同，加载时抛出异常，而不是读出错误的数据。
+//
+// key和value的编码由SnapshotCodec<T>决定：
+//   - 平凡可拷贝类型（整数、浮点、POD结构体）按内存原样写入
+//   - std::string写入32位长度 + 内容
+// 其他类型可以特化SnapshotCodec，提供write(SnapshotWriter&, const T&)和read(SnapshotReader&)。
+
+enum class SnapshotKind : uint32_t { LRU = 1, LFU = 2 };
+
+// 顺序写文件：先写到path.tmp，commit()时rename成目标文件，写到一半崩溃不会留下残缺的快照
+class SnapshotWriter
+{
+public:
+    explicit SnapshotWriter(const std::string& path) :m_path(path), m_tmp(path + ".tmp")
+    {
+        m_file = std::fopen(m_tmp.c_str(), "wb");
+        if (m_file == nullptr) throw std::runtime_error("cannot open " + m_tmp);
+        std::setvbuf(m_file, nullptr, _IOFBF, 1 << 16);
+    }
+
+    ~SnapshotWriter()
+    {
+        if (m_file != nullptr) {
+            std::fclose(m_file);
+            std::remove(m_tmp.c_str());
+        }
+    }
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    void write(const void* data, size_t size)
+    {
+        if (std::fwrite(data, 1, size, m_file) != size) throw std::runtime_error("write failed: " + m_tmp);
+    }
+
+    template<typename T>
+    void write_pod(const T& value) { write(&value, sizeof(T)); }
+
+    // 记住header中count字段的位置，写完条目后回填
+    long tell() const { return std::ftell(m_file); }
+
+    void patch_u64(long offset, uint64_t value)
+    {
+        long end = tell();
+        std::fseek(m_file, offset, SEEK_SET);
+        write_pod(value);
+        std::fseek(m_file, end, SEEK_SET);
+    }
+
+    void commit()
+    {
+        bool ok = std::fflush(m_file) == 0 && ::fsync(::fileno(m_file)) == 0;
+        ok = (std::fclose(m_file) == 0) && ok;
+        m_file = nullptr;
+        if (!ok || std::rename(m_tmp.c_str(), m_path.c_str()) != 0) {
+            std::remove(m_tmp.c_str());
+            throw std::runtime_error("cannot write snapshot " + m_path);
+        }
+    }
+
+private:
+    std::string m_path;
+    std::string m_tmp;
+    std::FILE* m_file = nullptr;
+};
+
+// 只读映射整个快照文件，按顺序解析；越界读取说明文件被截断或损坏，抛出异常
+class SnapshotReader
+{
+public:
+    explicit SnapshotReader(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot open " + path);
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error("invalid snapshot " + path);
+        }
+
+        m_size = static_cast<size_t>(st.st_size);
+        void* addr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);    // 映射建立后文件描述符就不再需要
+        if (addr == MAP_FAILED) throw std::runtime_error("cannot mmap " + path);
+
+        ::madvise(addr, m_size, MADV_SEQUENTIAL);   // 顺序读，让内核提前预读
+        m_base = static_cast<const char*>(addr);
+        m_pos = m_base;
+    }
+
+    ~SnapshotReader() { ::munmap(const_cast<char*>(m_base), m_size); }
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    // 返回当前位置并前进size字节
+    const char* take(size_t size)
+    {
+        if (size > static_cast<size_t>(m_base + m_size - m_pos)) throw std::runtime_error("truncated snapshot");
+        const char* p = m_pos;
+        m_pos += size;
+        return p;
+    }
+
+    template<typename T>
+    T read_pod()
+    {
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+private:
+    const char* m_base = nullptr;
+    const char* m_pos = nullptr;
+    size_t m_size = 0;
+};
+
+template<typename T, typename = void>
+struct SnapshotCodec;
+
+template<typename T>
+struct SnapshotCodec<T, std::enable_if_t<std::is_trivially_copyable_v<T>>> {
+    static void write(SnapshotWriter& out, const T& value) { out.write_pod(value); }
+    static T read(SnapshotReader& in) { return in.read_pod<T>(); }
+};
+
+template<>
+struct SnapshotCodec<std::string> {
+    static void write(SnapshotWriter& out, const std::string& value)
+    {
+        out.write_pod(static_cast<uint32_t>(value.size()));
+        out.write(value.data(), value.size());
+    }
+    static std::string read(SnapshotReader& in)
+    {
+        uint32_t size = in.read_pod<uint32_t>();
+        return std::string(in.take(size), size);
+    }
+};
+
+namespace snapshot_detail {
+
+constexpr char MAGIC[8] = {'L', 'Y', 'C', 'S', 'N', 'A', 'P', '1'};
+constexpr uint32_t VERSION = 3;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+// 类型标记：类别（有符号整数、无符号整数、浮点、字符串、其他）<< 16 | sizeof(T)
+template<typename T>
+constexpr uint32_t type_tag()
+{
+    uint32_t category = std::is_same_v<T, std::string> ? 4
+        : std::is_floating_point_v<T> ? 3
+        : std::is_integral_v<T> ? (std::is_signed_v<T> ? 1 : 2)
+        : 5;
+    return category << 16 | static_cast<uint32_t>(sizeof(T) & 0xffff);
+}
+
+// 写header，返回count字段的位置
+template<typename K, typename V>
+long write_header(SnapshotWriter& out, SnapshotKind kind)
+{
+    out.write(MAGIC, sizeof(MAGIC));
+    out.write_pod(BYTE_ORDER_MARK);
+    out.write_pod(static_cast<uint32_t>(kind));
+    out.write_pod(VERSION);
+    out.write_pod(type_tag<K>());
+    out.write_pod(type_tag<V>());
+    long count_offset = out.tell();
+    out.write_pod(uint64_t(0));
+    return count_offset;
+}
+
+// 校验header，返回条目数
+template<typename K, typename V>
+uint64_t read_header(SnapshotReader& in, SnapshotKind kind)
+{
+    if (std::memcmp(in.take(sizeof(MAGIC)), MAGIC, sizeof(MAGIC)) != 0)
+        throw std::runtime_error("not a cache snapshot");
+    // 先于其他字段检查，字节序不同时后面的字段都没有意义
+    if (in.read_pod<uint32_t>() != BYTE_ORDER_MARK)
+        throw std::runtime_error("snapshot was written on a machine with a different byte order");
+    if (in.read_pod<uint32_t>() != static_cast<uint32_t>(kind))
+        throw std::runtime_error("snapshot was written by a different cache type");
+    if (in.read_pod<uint32_t>() != VERSION)
+        throw std::runtime_error("unsupported snapshot version");
+    if (in.read_pod<uint32_t>() != type_tag<K>() || in.read_pod<uint32_t>() != type_tag<V>())
+        throw std::runtime_error("snapshot key/value types do not match the cache");
+    return in.read_pod<uint64_t>();
+}
+
+inline int64_t unix_ms_now()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace snapshot_detail
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+// 缓存统计，作为LRUCache/LFUCache的Stats模板参数：
+//  - NoStats（默认）：所有统计调用都是空的内联函数，编译后不产生任何代码
+//  - CacheStats：命中、未命中、插入、更新、按原因分类的淘汰计数，外加采样的get/put延迟直方图
+// 读取统计用snapshot()，可以在其他线程中随时调用。
+
+// 条目被移出缓存的原因
+enum class EvictReason : uint8_t {
+    Capacity,   // 容量不足被淘汰
+    Expired,    // TTL到期
+    Rejected,   // 条目本身超过整个预算，被拒绝写入或移除
+    COUNT
+};
+
+// 某一时刻的统计快照
+struct CacheStatsSnapshot {
+    // 延迟直方图按2的幂分桶：第i个桶统计 [2^i, 2^(i+1)) 纳秒，最后一个桶包含所有更大的值
+    static constexpr size_t LATENCY_BUCKETS = 32;
+    static constexpr size_t REASONS = static_cast<size_t>(EvictReason::COUNT);
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t inserts = 0;
+    uint64_t updates = 0;
+    uint64_t evictions[REASONS] = {};
+    uint64_t get_latency[LATENCY_BUCKETS] = {};
+    uint64_t put_latency[LATENCY_BUCKETS] = {};
+
+    double hit_ratio() const
+    {
+        uint64_t total = hits + misses;
+        return total ? static_cast<double>(hits) / total : 0.0;
+    }
+
+    uint64_t evicted(EvictReason reason) const { return evictions[static_cast<size_t>(reason)]; }
+
+    uint64_t evicted_total() const
+    {
+        uint64_t total = 0;
+        for (uint64_t n : evictions) total += n;
+        return total;
+    }
+
+    // 直方图的p分位（0~1），返回所在桶的上界（纳秒）；没有样本时返回0
+    static uint64_t percentile(const uint64_t (&hist)[LATENCY_BUCKETS], double p)
+    {
+        uint64_t total = 0;
+        for (uint64_t n : hist) total += n;
+        if (total == 0) return 0;
+
+        uint64_t rank = static_cast<uint64_t>(p * total);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+            seen += hist[i];
+            if (seen > rank) return uint64_t(1) << (i + 1);
+        }
+        return uint64_t(1) << LATENCY_BUCKETS;
+    }
+
+    void print(std::ostream& os = std::cout) const
+    {
+        os << "hits: " << hits << ", misses: " << misses << ", hit ratio: " << hit_ratio() << "\n";
+        os << "inserts: " << inserts << ", updates: " << updates << "\n";
+        os << "evictions: capacity " << evicted(EvictReason::Capacity)
+           << ", expired " << evicted(EvictReason::Expired)
+           << ", rejected " << evicted(EvictReason::Rejected) << "\n";
+        os << "get latency(ns): p50 <" << percentile(get_latency, 0.5)
+           << ", p99 <" << percentile(get_latency, 0.99)
+           << ", p999 <" << percentile(get_latency, 0.999) << "\n";
+        os << "put latency(ns): p50 <" << percentile(put_latency, 0.5)
+           << ", p99 <" << percentile(put_latency, 0.99)
+           << ", p999 <" << percentile(put_latency, 0.999) << "\n";
+    }
+};
+
+// 不做任何统计
+struct NoStats {
+    static constexpr bool enabled = false;
+
+    struct Sample {};
+
+    void hit(uint64_t = 1) {}
+    void miss(uint64_t = 1) {}
+    void inserted() {}
+    void updated() {}
+    void evicted(EvictReason) {}
+    Sample time_get() { return {}; }
+    Sample time_put() { return {}; }
+
+    CacheStatsSnapshot snapshot() const { return {}; }
+    void reset() {}
+};
+
+// 计数器按线程分散到多个独占缓存行的分片上，用relaxed原子加，不加锁、线程之间不争抢同一个缓存行。
+// 延迟每sample_every次操作采样一次（取2的幂），避免每次操作都读时钟。
+class CacheStats
+{
+public:
+    static constexpr bool enabled = true;
+    using Clock = std::chrono::steady_clock;
+
+    explicit CacheStats(uint32_t sample_every = 64) { set_sample_rate(sample_every); }
+
+    CacheStats(const CacheStats&) = delete;
+    CacheStats& operator=(const CacheStats&) = delete;
+
+    void set_sample_rate(uint32_t sample_every)
+    {
+        uint32_t rate = 1;
+        while (rate < sample_every) rate <<= 1;
+        m_sample_mask = rate - 1;
+    }
+
+    void hit(uint64_t n = 1) { add(local().hits, n); }
+    void miss(uint64_t n = 1) { add(local().misses, n); }
+    void inserted() { add(local().inserts); }
+    void updated() { add(local().updates); }
+    void evicted(EvictReason reason) { add(local().evictions[static_cast<size_t>(reason)]); }
+
+    // 计时对象：被采样时记录构造时刻，析构时把耗时计入直方图；未被采样时什么也不做
+    class Sample
+    {
+    public:
+        Sample() = default;
+        Sample(std::atomic<uint64_t>* hist) :m_hist(hist), m_start(Clock::now()) {}
+        Sample(Sample&& other) noexcept :m_hist(other.m_hist), m_start(other.m_start) { other.m_hist = nullptr; }
+        Sample(const Sample&) = delete;
+        Sample& operator=(const Sample&) = delete;
+
+        ~Sample()
+        {
+            if (m_hist == nullptr) return;
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start).count();
+            add(m_hist[bucket_of(static_cast<uint64_t>(ns))]);
+        }
+
+    private:
+        std::atomic<uint64_t>* m_hist = nullptr;
+        Clock::time_point m_start;
+    };
+
+    Sample time_get()
+    {
+        thread_local uint32_t ops = 0;
+        return (++ops & m_sample_mask) == 0 ? Sample(local().get_latency) : Sample();
+    }
+
+    // get和put分别计数，交替调用时两者都能被采样到
+    Sample time_put()
+    {
+        thread_local uint32_t ops = 0;
+        return (++ops & m_sample_mask) == 0 ? Sample(local().put_latency) : Sample();
+    }
+
+    // 汇总所有分片。与写入并发时各个计数器分别是某个时刻的值，彼此之间不保证严格一致
+    CacheStatsSnapshot snapshot() const
+    {
+        CacheStatsSnapshot s;
+        for (const Stripe& stripe : m_stripes) {
+            s.hits += load(stripe.hits);
+            s.misses += load(stripe.misses);
+            s.inserts += load(stripe.inserts);
+            s.updates += load(stripe.updates);
+            for (size_t i = 0; i < CacheStatsSnapshot::REASONS; ++i) s.evictions[i] += load(stripe.evictions[i]);
+            for (size_t i = 0; i < CacheStatsSnapshot::LATENCY_BUCKETS; ++i) {
+                s.get_latency[i] += load(stripe.get_latency[i]);
+                s.put_latency[i] += load(stripe.put_latency[i]);
+            }
+        }
+        return s;
+    }
+
+    void reset()
+    {
+        for (Stripe& stripe : m_stripes) {
+            stripe.hits = 0;
+            stripe.misses = 0;
+            stripe.inserts = 0;
+            stripe.updates = 0;
+            for (auto& n : stripe.evictions) n = 0;
+            for (auto& n : stripe.get_latency) n = 0;
+            for (auto& n : stripe.put_latency) n = 0;
+        }
+    }
+
+private:
+    static constexpr size_t STRIPES = 16;
+
+    struct alignas(64) Stripe {
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> inserts{0};
+        std::atomic<uint64_t> updates{0};
+        std::atomic<uint64_t> evictions[CacheStatsSnapshot::REASONS] = {};
+        std::atomic<uint64_t> get_latency[CacheStatsSnapshot::LATENCY_BUCKETS] = {};
+        std::atomic<uint64_t> put_latency[CacheStatsSnapshot::LATENCY_BUCKETS] = {};
+    };
+
+    static void add(std::atomic<uint64_t>& counter, uint64_t n = 1) { counter.fetch_add(n, std::memory_order_relaxed); }
+    static uint64_t load(const std::atomic<uint64_t>& counter) { return counter.load(std::memory_order_relaxed); }
+
+    static size_t bucket_of(uint64_t ns)
+    {
+        size_t bucket = 0;
+        while (ns > 1 && bucket + 1 < CacheStatsSnapshot::LATENCY_BUCKETS) {
+            ns >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    // 每个线程第一次使用时领一个固定的分片编号
+    static size_t thread_stripe()
+    {
+        static std::atomic<size_t> next{0};
+        thread_local size_t stripe = next.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+        return stripe;
+    }
+
+    Stripe& local() { return m_stripes[thread_stripe()]; }
+
+    uint32_t m_sample_mask = 63;
+    Stripe m_stripes[STRIPES];
+};
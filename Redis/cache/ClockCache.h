@@ -0,0 +1,311 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+// 基于epoch的内存回收（EBR）：
+//  - 读者进入临界区时在自己的槽位里登记当前全局epoch，退出时清零，整个过程没有锁，也不写共享的缓存行
+//  - 写者把节点从数据结构中摘下后不立即释放，而是连同当时的全局epoch放入待回收列表；
+//    所有正在读的线程登记的epoch都大于它时，说明已经没有读者能看到这个节点，才真正释放
+// 每个线程第一次使用时占用一个槽位，线程退出时归还。整个进程共用一个域。
+class EpochDomain
+{
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{0};     // 0表示不在读临界区
+        std::atomic<bool> used{false};
+    };
+
+public:
+    static constexpr size_t MAX_THREADS = 256;
+
+    static EpochDomain& instance()
+    {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    // 读临界区，同一线程内可以嵌套
+    class Guard
+    {
+    public:
+        explicit Guard(EpochDomain& domain) :m_slot(domain.localSlot())
+        {
+            m_outer = m_slot.epoch.load(std::memory_order_relaxed) == 0;
+            if (m_outer) {
+                m_slot.epoch.store(domain.m_global.load(std::memory_order_acquire), std::memory_order_relaxed);
+                // 登记必须先于之后对数据结构的读取被写者看到
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+        ~Guard()
+        {
+            if (m_outer) m_slot.epoch.store(0, std::memory_order_release);
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        Slot& m_slot;
+        bool m_outer;
+    };
+
+    uint64_t current() const { return m_global.load(std::memory_order_acquire); }
+
+    void advance() { m_global.fetch_add(1, std::memory_order_acq_rel); }
+
+    // 所有活跃读者登记的最小epoch，没有活跃读者时返回UINT64_MAX；epoch小于它的节点可以安全释放
+    uint64_t minActive() const
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t min = UINT64_MAX;
+        for (const Slot& slot : m_slots) {
+            uint64_t epoch = slot.epoch.load(std::memory_order_acquire);
+            if (epoch != 0 && epoch < min) min = epoch;
+        }
+        return min;
+    }
+
+private:
+    // 线程退出时归还槽位
+    struct Registration {
+        Slot* slot = nullptr;
+        ~Registration() { if (slot) slot->used.store(false, std::memory_order_release); }
+    };
+
+    Slot& localSlot()
+    {
+        thread_local Registration reg;
+        if (reg.slot == nullptr) {
+            for (Slot& slot : m_slots) {
+                bool expected = false;
+                if (!slot.used.load(std::memory_order_relaxed) &&
+                    slot.used.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                    reg.slot = &slot;
+                    break;
+                }
+            }
+            if (reg.slot == nullptr) throw std::runtime_error("EpochDomain: too many threads");
+        }
+        return *reg.slot;
+    }
+
+    std::atomic<uint64_t> m_global{1};
+    Slot m_slots[MAX_THREADS];
+};
+
+// CLOCK近似LRU，读多写少场景下get不加锁：
+//  - 哈希表是固定桶数的链表数组，桶头和next指针都是原子指针，读者无锁遍历
+//  - 命中只把条目的引用位置1（已经是1时不写），不移动任何节点
+//  - 写操作（put/erase/淘汰）由一把互斥锁串行化。条目发布后不再修改，
+//    更新值时换上一个新条目，旧条目交给EpochDomain延迟释放
+//  - 淘汰时时钟指针扫过环形数组：引用位为1的清零后跳过（给第二次机会），为0的淘汰
+// 值按拷贝返回，不返回指针：读者离开临界区后条目随时可能被释放。
+template<typename K, typename V, typename Hash = std::hash<K>>
+class ClockCache
+{
+    public:
+        ClockCache(size_t capacity) : m_capacity(capacity), m_ring(capacity, nullptr)
+        {
+            size_t buckets = 16;
+            while (buckets < capacity) buckets <<= 1;
+            m_buckets.reset(new std::atomic<Entry*>[buckets]);
+            for (size_t i = 0; i < buckets; ++i) m_buckets[i].store(nullptr, std::memory_order_relaxed);
+            m_mask = buckets - 1;
+
+            m_free.reserve(capacity);
+            for (size_t i = capacity; i > 0; --i) m_free.push_back(i - 1);
+        }
+
+        // 析构时不能再有其他线程访问
+        ~ClockCache()
+        {
+            for (Entry* e : m_ring) delete e;
+            for (auto& r : m_retired) delete r.entry;
+        }
+
+        ClockCache(const ClockCache&) = delete;
+        ClockCache& operator=(const ClockCache&) = delete;
+
+        V get(const K& key)
+        {
+            std::optional<V> value = find(key);
+            if (!value) throw std::out_of_range("Key not found");
+            return *value;
+        }
+
+        // 无锁查找：命中时置引用位并返回值的拷贝
+        std::optional<V> find(const K& key)
+        {
+            EpochDomain::Guard guard(m_domain);
+            uint64_t hash = hash_of(key);
+            for (Entry* e = m_buckets[hash & m_mask].load(std::memory_order_acquire); e != nullptr;
+                 e = e->next.load(std::memory_order_acquire)) {
+                if (e->hash == hash && e->key == key) {
+                    if (!e->ref.load(std::memory_order_relaxed)) e->ref.store(1, std::memory_order_relaxed);
+                    return e->value;
+                }
+            }
+            return std::nullopt;
+        }
+
+        bool contains(const K& key) { return find(key).has_value(); }
+
+        void put(const K& key, const V& value)
+        {
+            if (m_capacity == 0) return;
+
+            uint64_t hash = hash_of(key);
+            Entry* fresh = new Entry(key, value, hash);
+
+            std::lock_guard<std::mutex> lock(m_write);
+            std::atomic<Entry*>* link = findLink(key, hash);
+            if (Entry* old = link->load(std::memory_order_relaxed)) {
+                // 已存在：新条目接替旧条目在链表和时钟环中的位置
+                fresh->next.store(old->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                fresh->ref.store(old->ref.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                fresh->slot = old->slot;
+                m_ring[fresh->slot] = fresh;
+                link->store(fresh, std::memory_order_release);
+                retire(old);
+                return;
+            }
+
+            size_t slot;
+            if (!m_free.empty()) {
+                slot = m_free.back();
+                m_free.pop_back();
+            } else {
+                slot = evict();
+            }
+
+            // 淘汰可能改动了同一个桶，桶头在淘汰之后再读
+            std::atomic<Entry*>& bucket = m_buckets[hash & m_mask];
+            fresh->slot = slot;
+            fresh->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            m_ring[slot] = fresh;
+            bucket.store(fresh, std::memory_order_release);
+            m_size.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        bool erase(const K& key)
+        {
+            uint64_t hash = hash_of(key);
+            std::lock_guard<std::mutex> lock(m_write);
+            std::atomic<Entry*>* link = findLink(key, hash);
+            Entry* e = link->load(std::memory_order_relaxed);
+            if (e == nullptr) return false;
+
+            link->store(e->next.load(std::memory_order_relaxed), std::memory_order_release);
+            m_ring[e->slot] = nullptr;
+            m_free.push_back(e->slot);
+            m_size.fetch_sub(1, std::memory_order_relaxed);
+            retire(e);
+            return true;
+        }
+
+        size_t size() const { return m_size.load(std::memory_order_relaxed); }
+        size_t capacity() const { return m_capacity; }
+
+    private:
+        static constexpr size_t RECLAIM_BATCH = 64;    // 待回收条目攒够这么多再尝试释放
+
+        struct Entry {
+            K key;
+            V value;
+            uint64_t hash;
+            std::atomic<Entry*> next{nullptr};
+            std::atomic<uint8_t> ref{0};    // CLOCK引用位
+            size_t slot = 0;                // 在时钟环中的位置，只由写者访问
+            Entry(const K& k, const V& v, uint64_t h) :key(k), value(v), hash(h) {}
+        };
+
+        struct Retired {
+            Entry* entry;
+            uint64_t epoch;
+        };
+
+        uint64_t hash_of(const K& key) const
+        {
+            uint64_t h = m_hasher(key);
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+        // 持写锁调用：返回指向key所在条目的链接（桶头或前一个条目的next），不存在时链接的值为nullptr
+        std::atomic<Entry*>* findLink(const K& key, uint64_t hash)
+        {
+            std::atomic<Entry*>* link = &m_buckets[hash & m_mask];
+            for (Entry* e = link->load(std::memory_order_relaxed); e != nullptr; e = link->load(std::memory_order_relaxed)) {
+                if (e->hash == hash && e->key == key) break;
+                link = &e->next;
+            }
+            return link;
+        }
+
+        // 持写锁调用：转动时钟指针淘汰一个引用位为0的条目，返回空出来的环位置
+        size_t evict()
+        {
+            for (;;) {
+                size_t pos = m_hand;
+                m_hand = (m_hand + 1) % m_capacity;
+
+                Entry* e = m_ring[pos];
+                if (e == nullptr) continue;
+                if (e->ref.load(std::memory_order_relaxed)) {
+                    e->ref.store(0, std::memory_order_relaxed);
+                    continue;
+                }
+
+                std::atomic<Entry*>* link = findLink(e->key, e->hash);
+                link->store(e->next.load(std::memory_order_relaxed), std::memory_order_release);
+                m_ring[pos] = nullptr;
+                m_size.fetch_sub(1, std::memory_order_relaxed);
+                retire(e);
+                return pos;
+            }
+        }
+
+        // 持写锁调用：条目已从链表摘下，正在读它的线程仍可沿着它的next继续遍历
+        void retire(Entry* e)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_retired.push_back(Retired{e, m_domain.current()});
+            if (m_retired.size() >= RECLAIM_BATCH) reclaim();
+        }
+
+        void reclaim()
+        {
+            m_domain.advance();
+            uint64_t safe = m_domain.minActive();
+
+            size_t kept = 0;
+            for (Retired& r : m_retired) {
+                if (r.epoch < safe) delete r.entry;
+                else m_retired[kept++] = r;
+            }
+            m_retired.resize(kept);
+        }
+
+        size_t m_capacity;
+        size_t m_mask;
+        std::unique_ptr<std::atomic<Entry*>[]> m_buckets;
+        std::atomic<size_t> m_size{0};
+        Hash m_hasher;
+        EpochDomain& m_domain = EpochDomain::instance();
+
+        // 以下只由持有m_write的写者访问
+        std::mutex m_write;
+        std::vector<Entry*> m_ring;         // 时钟环，nullptr为空位
+        std::vector<size_t> m_free;         // 空位下标
+        size_t m_hand = 0;                  // 时钟指针
+        std::vector<Retired> m_retired;     // 等待回收的条目
+};
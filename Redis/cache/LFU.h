@@ -0,0 +1,532 @@
+#pragma once
+
+#include <iostream>
+#include <unordered_map>
+#include <list>
+#include <stdexcept>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "CacheSize.h"
+#include "CacheHash.h"
+#include "TimingWheel.h"
+#include "CacheStats.h"
+#include "CacheSnapshot.h"
+
+// O(1) LFU：
+//  - 相同频率的节点放在同一个频率桶里，桶按频率升序串成链表，表头就是最小频率
+//  - 命中时把节点从当前桶splice到下一个频率桶，节点本身不拷贝、不重新分配
+//  - 空桶放入备用链表复用，淘汰时复用被淘汰节点和哈希表节点，稳定运行时没有堆分配
+// Sizer决定容量的计量方式：默认EntryCount按条目数，ByteSize按字节预算
+// 支持按条目设置TTL：get时惰性检查过期，时间轮负责主动回收长期无人访问的过期条目
+// Hash/KeyEqual默认对std::string透明，find()可以直接用std::string_view查询
+// 频率只增不减，热点会变化的场景可以用PolicyCache<K, V, RedisLFUPolicy>（对数计数器 + 按时间衰减）
+// Stats默认NoStats不做统计，换成CacheStats后可以用stats().snapshot()读取命中率、淘汰数和延迟分布
+template <typename K, typename V, typename Sizer = EntryCount,
+          typename Hash = CacheHash<K>, typename KeyEqual = CacheKeyEqual<K>, typename Stats = NoStats>
+class LFUCache
+{
+public:
+    struct Node;
+    struct Bucket {
+        size_t freq;            // 频率
+        std::list<Node> nodes;  // 该频率下的节点，头部最新
+        explicit Bucket(size_t f) :freq(f) {}
+    };
+    using BucketIter = typename std::list<Bucket>::iterator;
+    using NodeIter = typename std::list<Node>::iterator;
+    using Timer = typename TimingWheel<NodeIter>::Handle;
+
+    struct Node {
+        K key;
+        V value;
+        BucketIter bucket;      // 节点所在的频率桶
+        uint64_t expire;        // 到期tick，NO_EXPIRE表示永不过期
+        Timer timer;            // expire有效时指向时间轮中的定时器
+        template<typename KK, typename... Args>
+        Node(BucketIter b, KK&& k, Args&&... args)
+            :key(std::forward<KK>(k)), value(std::forward<Args>(args)...), bucket(b), expire(NO_EXPIRE) {}
+    };
+
+    using key_type = K;
+    using mapped_type = V;
+
+    LFUCache(size_t capacity) :m_capacity(capacity) {}
+
+    V get(K key)
+    {
+        V* value = find(key);
+        if (value == nullptr) throw std::out_of_range("Key not found");
+        return *value;
+    }
+
+    // 不抛异常、不拷贝的查找：命中返回值的指针（同时增加频率），未命中返回nullptr。
+    // 指针在该条目被淘汰、删除或过期之前有效。
+    template<typename Q>
+    V* find(const Q& key)
+    {
+        [[maybe_unused]] auto sample = m_stats.time_get();
+        auto it = cache_find(m_cache, key);
+        if (it == m_cache.end()) {
+            m_stats.miss();
+            return nullptr;
+        }
+
+        NodeIter node = it->second;
+        if (node->expire != NO_EXPIRE && node->expire <= m_wheel.now()) {
+            evict(node);
+            m_stats.evicted(EvictReason::Expired);
+            m_stats.miss();
+            return nullptr;
+        }
+
+        // 更新频率，迭代器在splice后依然有效
+        updateFreq(node);
+        m_stats.hit();
+        return &node->value;
+    }
+
+    template<typename Q>
+    bool contains(const Q& key)
+    {
+        return find(key) != nullptr;
+    }
+
+    // 条目的剩余存活时间，不改变访问顺序；key不存在、已过期或没有TTL时返回std::nullopt
+    template<typename Q>
+    std::optional<std::chrono::milliseconds> ttl(const Q& key) const
+    {
+        auto it = cache_find(m_cache, key);
+        if (it == m_cache.end() || it->second->expire == NO_EXPIRE) return std::nullopt;
+
+        uint64_t now = m_wheel.now();
+        if (it->second->expire <= now) return std::nullopt;
+        return m_wheel.tick_duration() * (it->second->expire - now);
+    }
+
+    // 批量查找：out[i]为keys[i]对应值的指针，未命中为nullptr，返回命中数。
+    // 每组key分三轮处理：先全部计算哈希并定位桶、预取桶内节点，再在桶内比较key并预取链表节点，
+    // 最后统一检查过期、增加频率，使各个key的缓存未命中互相重叠而不是串行等待。
+    // 已过期的条目按未命中处理（不在这里删除，同一批中可能有重复的key），留给时间轮回收。
+    size_t get_many(const std::vector<K>& keys, std::vector<V*>& out)
+    {
+        out.assign(keys.size(), nullptr);
+        size_t hits = 0;
+        uint64_t now = m_wheel.now();
+
+        for (size_t begin = 0; begin < keys.size(); begin += BATCH_GROUP) {
+            size_t n = std::min(BATCH_GROUP, keys.size() - begin);
+            const K* group = keys.data() + begin;
+            size_t buckets[BATCH_GROUP];
+            NodeIter nodes[BATCH_GROUP];
+            bool found[BATCH_GROUP];
+
+            for (size_t i = 0; i < n; ++i) {
+                buckets[i] = m_cache.bucket(group[i]);
+                auto lit = m_cache.begin(buckets[i]);
+                if (lit != m_cache.end(buckets[i])) cache_prefetch(&*lit);
+            }
+
+            for (size_t i = 0; i < n; ++i) {
+                found[i] = false;
+                for (auto lit = m_cache.begin(buckets[i]); lit != m_cache.end(buckets[i]); ++lit) {
+                    if (m_cache.key_eq()(lit->first, group[i])) {
+                        nodes[i] = lit->second;
+                        found[i] = true;
+                        cache_prefetch(&*nodes[i]);
+                        break;
+                    }
+                }
+            }
+
+            // 移动到下一个频率桶要访问节点所在的桶，先把桶也预取进来
+            for (size_t i = 0; i < n; ++i)
+                if (found[i]) cache_prefetch(&*nodes[i]->bucket);
+
+            for (size_t i = 0; i < n; ++i) {
+                if (!found[i]) continue;
+                NodeIter node = nodes[i];
+                if (node->expire != NO_EXPIRE && node->expire <= now) continue;
+
+                updateFreq(node);
+                out[begin + i] = &node->value;
+                ++hits;
+            }
+        }
+
+        m_stats.hit(hits);
+        m_stats.miss(keys.size() - hits);
+        return hits;
+    }
+
+    // 批量写入：先为整批key预取桶，再逐个写入
+    void put_many(const std::vector<std::pair<K, V>>& items)
+    {
+        for (size_t begin = 0; begin < items.size(); begin += BATCH_GROUP) {
+            size_t n = std::min(BATCH_GROUP, items.size() - begin);
+            for (size_t i = 0; i < n; ++i) {
+                size_t bucket = m_cache.bucket(items[begin + i].first);
+                auto lit = m_cache.begin(bucket);
+                if (lit != m_cache.end(bucket)) cache_prefetch(&*lit);
+            }
+            for (size_t i = 0; i < n; ++i)
+                put(items[begin + i].first, items[begin + i].second);
+        }
+    }
+
+    // key不存在时用args原地构造值并插入，返回{值的指针, 是否插入}；
+    // key已存在时不构造，只增加频率。条目超过整个预算时返回{nullptr, false}
+    template<typename Q, typename... Args>
+    std::pair<V*, bool> try_emplace(Q&& key, Args&&... args)
+    {
+        if (m_capacity <= 0) return {nullptr, false};
+        if (V* value = find(key)) return {value, false};
+
+        expire();
+        BucketIter first = frequencyOneBucket();
+        first->nodes.emplace_front(first, std::forward<Q>(key), std::forward<Args>(args)...);
+        NodeIter node = first->nodes.begin();
+
+        size_t charge = m_sizer(node->key, node->value);
+        if (charge > m_capacity) {
+            first->nodes.erase(node);
+            if (first->nodes.empty()) retireBucket(first);
+            m_stats.evicted(EvictReason::Rejected);
+            return {nullptr, false};
+        }
+
+        m_used += charge;
+        evictUntilFits(node);
+        m_cache.emplace(node->key, node);
+        updatePeak();
+        m_stats.inserted();
+        return {&node->value, true};
+    }
+
+    // 不带TTL的写入，会清除已有的TTL
+    void put(K key, V value)
+    {
+        putImpl(key, value, NO_EXPIRE);
+    }
+
+    // 带TTL的写入，ttl之后条目失效
+    void put(K key, V value, std::chrono::milliseconds ttl)
+    {
+        // tick 0 表示永不过期，到期时间至少取1
+        putImpl(key, value, std::max<uint64_t>(m_wheel.tick_of(std::chrono::steady_clock::now() + ttl), 1));
+    }
+
+    // 推进时间轮，回收所有已到期的条目；put时会自动调用，也可以由后台定时调用
+    void expire()
+    {
+        m_wheel.advance(m_wheel.now(), [this](NodeIter node) {
+            node->expire = NO_EXPIRE;   // 定时器已由时间轮释放
+            remove(node);
+            m_stats.evicted(EvictReason::Expired);
+        });
+    }
+
+    size_t size() const { return m_cache.size(); }
+    size_t capacity() const { return m_capacity; }
+
+    // 当前占用和历史峰值（ByteSize下为字节数，EntryCount下为条目数）
+    size_t bytes() const { return m_used; }
+    size_t peak_bytes() const { return m_peak; }
+
+    Stats& stats() { return m_stats; }
+    const Stats& stats() const { return m_stats; }
+
+    // 把当前内容写成快照文件（格式见CacheSnapshot.h）：频率升序，同频率内从最旧到最新，已过期的条目不写入
+    void save(const std::string& path) const
+    {
+        SnapshotWriter out(path);
+        long count_offset = snapshot_detail::write_header<K, V>(out, SnapshotKind::LFU);
+        uint64_t now = m_wheel.now();
+        int64_t now_ms = snapshot_detail::unix_ms_now();
+        uint64_t count = 0;
+
+        for (auto& bucket : m_buckets) {
+            for (auto it = bucket.nodes.rbegin(); it != bucket.nodes.rend(); ++it) {
+                if (it->expire != NO_EXPIRE && it->expire <= now) continue;
+                int64_t expire_ms = it->expire == NO_EXPIRE ? 0 :
+                    now_ms + m_wheel.tick_duration().count() * static_cast<int64_t>(it->expire - now);
+                out.write_pod(static_cast<uint64_t>(bucket.freq));
+                out.write_pod(expire_ms);
+                SnapshotCodec<K>::write(out, it->key);
+                SnapshotCodec<V>::write(out, it->value);
+                ++count;
+            }
+        }
+
+        out.patch_u64(count_offset, count);
+        out.commit();
+    }
+
+    // 通过mmap读取快照并依次写入，恢复每个条目的频率，返回写入的条目数（不含已经过期的）。
+    // 条目按频率升序插入，快照比容量大时低频条目被淘汰。一般在启动时对空缓存调用，已有的同名key会被覆盖
+    size_t load(const std::string& path)
+    {
+        SnapshotReader in(path);
+        uint64_t count = snapshot_detail::read_header<K, V>(in, SnapshotKind::LFU);
+        int64_t now_ms = snapshot_detail::unix_ms_now();
+        size_t loaded = 0;
+
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t freq = in.read_pod<uint64_t>();
+            int64_t expire_ms = in.read_pod<int64_t>();
+            K key = SnapshotCodec<K>::read(in);
+            V value = SnapshotCodec<V>::read(in);
+
+            if (expire_ms == 0) putImpl(key, value, NO_EXPIRE);
+            else if (expire_ms > now_ms) put(key, value, std::chrono::milliseconds(expire_ms - now_ms));
+            else continue;
+
+            auto it = m_cache.find(key);
+            if (it != m_cache.end()) restoreFreq(it->second, freq);
+            ++loaded;
+        }
+        return loaded;
+    }
+
+    void print()
+    {
+        std::cout << "==============================\n";
+        std::cout << "Print\n";
+        for (auto& bucket : m_buckets) {
+            std::cout << "Frequency: " << bucket.freq;
+            for (auto& node : bucket.nodes) {
+                std::cout << "  Key: " << node.key << " value: " << node.value << std::endl;
+            }
+        }
+        std::cout << "==============================\n";
+    }
+private:
+    static constexpr uint64_t NO_EXPIRE = 0;
+    static constexpr size_t BATCH_GROUP = 16;  // 批量接口每组同时在途的key数
+
+    using Map = std::unordered_map<K, NodeIter, Hash, KeyEqual>;
+    using MapNode = typename Map::node_type;
+
+    size_t m_capacity;
+    size_t m_used = 0;              // 当前占用
+    size_t m_peak = 0;              // 占用峰值
+    Sizer m_sizer;
+    Stats m_stats;
+    TimingWheel<NodeIter> m_wheel;
+    Map m_cache;
+    std::list<Bucket> m_buckets;    // 频率桶链表，按频率升序，表头为最小频率
+    std::list<Bucket> m_spare;      // 已清空的桶，留着复用
+    std::list<Node> m_spareNodes;   // 最近一次淘汰的链表节点，留着复用
+    MapNode m_spareEntry;           // 最近一次淘汰的哈希表节点，留着复用
+
+    void putImpl(const K& key, const V& value, uint64_t expire_tick)
+    {
+        if (m_capacity <= 0) return;
+
+        [[maybe_unused]] auto sample = m_stats.time_put();
+        expire();
+
+        size_t charge = m_sizer(key, value);
+
+        // 如果键已存在, 更新值和频率
+        auto it = m_cache.find(key);
+        if (it != m_cache.end()) {
+            NodeIter node = it->second;
+            if (charge > m_capacity) {
+                // 新值本身就超过了预算，直接移除
+                evict(node);
+                m_stats.evicted(EvictReason::Rejected);
+                return;
+            }
+            m_used = m_used - m_sizer(key, node->value) + charge;
+            node->value = value;
+            setExpire(node, expire_tick);
+            updateFreq(node);
+            evictUntilFits(node);
+            updatePeak();
+            m_stats.updated();
+            return;
+        }
+
+        if (charge > m_capacity) {
+            m_stats.evicted(EvictReason::Rejected);
+            return;
+        }
+
+        // 超出容量时不断移除最小频率桶中最旧的节点，直到新节点放得下
+        while (m_cache.size() > 0 && m_used + charge > m_capacity) {
+            evict(minFreqVictim());
+            m_stats.evicted(EvictReason::Capacity);
+        }
+
+        // 插入新节点,频率为1，优先复用刚被淘汰的链表节点和哈希表节点
+        BucketIter first = frequencyOneBucket();
+        if (!m_spareNodes.empty()) {
+            NodeIter node = m_spareNodes.begin();
+            node->key = key;
+            node->value = value;
+            node->bucket = first;
+            node->expire = NO_EXPIRE;
+            first->nodes.splice(first->nodes.begin(), m_spareNodes, node);
+        } else {
+            first->nodes.emplace_front(first, key, value);
+        }
+        setExpire(first->nodes.begin(), expire_tick);
+
+        if (!m_spareEntry.empty()) {
+            m_spareEntry.key() = key;
+            m_spareEntry.mapped() = first->nodes.begin();
+            m_cache.insert(std::move(m_spareEntry));
+        } else {
+            m_cache.emplace(key, first->nodes.begin());
+        }
+
+        m_used += charge;
+        updatePeak();
+        m_stats.inserted();
+    }
+
+    // 淘汰最小频率的节点（跳过keep），直到占用不超过容量
+    void evictUntilFits(NodeIter keep)
+    {
+        while (m_used > m_capacity) {
+            evict(minFreqVictim(keep));
+            m_stats.evicted(EvictReason::Capacity);
+        }
+    }
+
+    // 最小频率桶中最旧的节点
+    NodeIter minFreqVictim()
+    {
+        return std::prev(m_buckets.front().nodes.end());
+    }
+
+    // 同上，但跳过正在更新的节点keep
+    NodeIter minFreqVictim(NodeIter keep)
+    {
+        for (auto& bucket : m_buckets) {
+            for (auto node = bucket.nodes.rbegin(); node != bucket.nodes.rend(); ++node) {
+                NodeIter it = std::prev(node.base());
+                if (it != keep) return it;
+            }
+        }
+        return keep;
+    }
+
+    void setExpire(NodeIter node, uint64_t expire_tick)
+    {
+        if (expire_tick == NO_EXPIRE) {
+            if (node->expire != NO_EXPIRE) m_wheel.cancel(node->timer);
+        } else if (node->expire != NO_EXPIRE) {
+            m_wheel.reschedule(node->timer, expire_tick);
+        } else {
+            node->timer = m_wheel.schedule(node, expire_tick);
+        }
+        node->expire = expire_tick;
+    }
+
+    // 移除节点，同时取消它的定时器
+    void evict(NodeIter node)
+    {
+        setExpire(node, NO_EXPIRE);
+        remove(node);
+    }
+
+    // 移除节点，不处理定时器；节点和哈希表节点各保留一个用于下次插入。
+    // 保留前换成空的key和值，释放它们的堆内存，被淘汰的大值不会留在容量预算之外；不能默认构造的类型不保留
+    void remove(NodeIter node)
+    {
+        m_used -= m_sizer(node->key, node->value);
+        BucketIter bucket = node->bucket;
+
+        if constexpr (std::is_default_constructible_v<K> && std::is_default_constructible_v<V>) {
+            m_spareEntry = m_cache.extract(node->key);
+            release(m_spareEntry.key());
+            release(node->key);
+            release(node->value);
+            m_spareNodes.clear();
+            m_spareNodes.splice(m_spareNodes.begin(), bucket->nodes, node);
+        } else {
+            m_cache.erase(node->key);
+            bucket->nodes.erase(node);
+        }
+        if (bucket->nodes.empty()) retireBucket(bucket);
+    }
+
+    // 与空对象交换，原来的内容随临时对象析构释放（字符串的移动赋值可能保留原有的缓冲区）
+    template<typename T>
+    static void release(T& value)
+    {
+        T empty{};
+        using std::swap;
+        swap(value, empty);
+    }
+
+    void updatePeak() { if (m_used > m_peak) m_peak = m_used; }
+
+    // 在pos之前放入一个频率为freq的空桶，优先复用备用桶
+    BucketIter makeBucket(BucketIter pos, size_t freq)
+    {
+        if (m_spare.empty()) return m_buckets.emplace(pos, freq);
+
+        BucketIter bucket = m_spare.begin();
+        bucket->freq = freq;
+        m_buckets.splice(pos, m_spare, bucket);
+        return bucket;
+    }
+
+    void retireBucket(BucketIter bucket)
+    {
+        m_spare.splice(m_spare.begin(), m_buckets, bucket);
+    }
+
+    // 返回频率为1的桶，不存在时在表头创建
+    BucketIter frequencyOneBucket()
+    {
+        if (!m_buckets.empty() && m_buckets.front().freq == 1) return m_buckets.begin();
+        return makeBucket(m_buckets.begin(), 1);
+    }
+
+    // 把节点移动到频率为freq的桶的头部，freq不高于当前频率时不变
+    void restoreFreq(NodeIter node, size_t freq)
+    {
+        BucketIter cur = node->bucket;
+        if (freq <= cur->freq) return;
+
+        BucketIter target = std::next(cur);
+        while (target != m_buckets.end() && target->freq < freq) ++target;
+        if (target == m_buckets.end() || target->freq != freq)
+            target = makeBucket(target, freq);
+
+        target->nodes.splice(target->nodes.begin(), cur->nodes, node);
+        node->bucket = target;
+        if (cur->nodes.empty()) retireBucket(cur);
+    }
+
+    void updateFreq(NodeIter node)
+    {
+        BucketIter cur = node->bucket;
+        size_t new_freq = cur->freq + 1;
+        BucketIter next = std::next(cur);
+
+        // 桶里只有这一个节点且下一个频率桶不存在，直接把桶的频率加一即可
+        if (cur->nodes.size() == 1 && (next == m_buckets.end() || next->freq != new_freq)) {
+            cur->freq = new_freq;
+            return;
+        }
+
+        if (next == m_buckets.end() || next->freq != new_freq)
+            next = makeBucket(next, new_freq);
+
+        // 把节点移动到新频率桶的头部
+        next->nodes.splice(next->nodes.begin(), cur->nodes, node);
+        node->bucket = next;
+
+        // 如果原频率桶为空，回收它
+        if (cur->nodes.empty()) retireBucket(cur);
+    }
+};
@@ -1,60 +1,8 @@
-#include <iostream>
-#include <list>
-#include <unordered_map>
+#include <thread>
 
-using namespace std;
-
-template<typename K, typename V>
-class LRUCache
-{
-    public:
-        LRUCache(size_t capacity) : m_capacity(capacity){}
-
-        V get(K key)
-        {
-            auto it = m_cache.find(key);
-            if (it == m_cache.end()) throw out_of_range("Key not found");
-
-            m_lru.splice(m_lru.begin(), m_lru, it->second); // 将节点移动到链表头部
-            return it->second->second;
-        }
-
-        void put(K key, V value)
-        {
-            auto it = m_cache.find(key);
-            if (it != m_cache.end())
-            {
-                it->second->second = value; // 更新值
-                m_lru.splice(m_lru.begin(), m_lru, it->second); // 更新节点位置
-                return;
-            }
-            
-            // 检查容量是否超出，如果超出则删除最旧的元素（尾部）
-            if (m_lru.size() >= m_capacity)
-            {
-                // 淘汰尾部元素
-                auto last = m_lru.back();
-                m_cache.erase(last->first); // 从哈希表中删除该元素
-                m_lru.pop_back(); // 移除链表中的最后一个节点
-            }
-
-            // 插入新元素到头部
-            m_lru.emplace_front(key, value);
-            m_cache[key] = m_lru.begin();
-        }
-
-        void print()
-        {
-            for (auto& item : m_lru)
-                cout << "Key: " << item.first << ", Value: " << item.second << "-> ";
+#include "LRU.h"
 
-            cout<<"nullptr\n";
-        }
-    private:
-        size_t m_capacity;
-        list<pair<K, V>> m_lru;      //存储键值对，头部最新，尾部最旧
-        unordered_map<K, typename list<pair<K, V>>::iterator> m_cache;
-};
+using namespace std;
 
 int main()
 {
@@ -78,5 +26,39 @@ int main()
     cout<<"Get key 3: "<<cache.get(3)<<endl;
     cache.print();
 
+    // 不抛异常的查找：未命中返回nullptr
+    if (int* value = cache.find(1)) cout<<"Find key 1: "<<*value<<endl;
+    else cout<<"Find key 1: miss"<<endl;
+
+    // 按字节预算的缓存：容量为1KB，放入大小不一的值
+    LRUCache<int, string, ByteSize> bytes_cache(1024);
+    bytes_cache.put(1, string(100, 'a'));
+    bytes_cache.put(2, string(500, 'b'));
+    bytes_cache.put(3, string(300, 'c')); // 放不下，淘汰键1
+    cout<<"Entries: "<<bytes_cache.size()<<", bytes: "<<bytes_cache.bytes()
+        <<", peak bytes: "<<bytes_cache.peak_bytes()<<endl;
+
+    // 带TTL的条目：过期后get抛出异常，expire()主动回收
+    LRUCache<int, int> ttl_cache(3);
+    ttl_cache.put(1, 1, chrono::milliseconds(50));
+    ttl_cache.put(2, 2);
+    this_thread::sleep_for(chrono::milliseconds(100));
+    ttl_cache.expire();
+    cout<<"Entries after expire: "<<ttl_cache.size()<<endl;
+
+    // 打开统计：命中率、淘汰数和采样的延迟分布，snapshot()可以随时读取
+    LRUCache<int, int, EntryCount, CacheHash<int>, CacheKeyEqual<int>, CacheStats> stats_cache(100);
+    for (int i = 0; i < 10000; ++i) {
+        int key = i % 5 == 0 ? i % 1000 : i % 50;   // 80%的访问集中在50个key上
+        if (!stats_cache.find(key)) stats_cache.put(key, i);
+    }
+    stats_cache.stats().snapshot().print();
+
+    // 快照：写到磁盘，重启后mmap读回，访问顺序保持不变
+    cache.save("lru.snap");
+    LRUCache<int, int> restored(3);
+    cout<<"Loaded "<<restored.load("lru.snap")<<" entries from snapshot"<<endl;
+    restored.print();
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,403 @@
+#pragma once
+
+#include <iostream>
+#include <list>
+#include <unordered_map>
+#include <stdexcept>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+#include <optional>
+
+#include "CacheSize.h"
+#include "CacheHash.h"
+#include "TimingWheel.h"
+#include "CacheStats.h"
+#include "CacheSnapshot.h"
+
+// Sizer决定容量的计量方式：默认EntryCount按条目数，ByteSize按字节预算
+// 支持按条目设置TTL：get时惰性检查过期，时间轮负责主动回收长期无人访问的过期条目
+// Hash/KeyEqual默认对std::string透明，find()可以直接用std::string_view查询
+// Stats默认NoStats不做统计，换成CacheStats后可以用stats().snapshot()读取命中率、淘汰数和延迟分布
+template<typename K, typename V, typename Sizer = EntryCount,
+         typename Hash = CacheHash<K>, typename KeyEqual = CacheKeyEqual<K>, typename Stats = NoStats>
+class LRUCache
+{
+    public:
+        using key_type = K;
+        using mapped_type = V;
+
+        LRUCache(size_t capacity) : m_capacity(capacity){}
+
+        V get(K key)
+        {
+            V* value = find(key);
+            if (value == nullptr) throw std::out_of_range("Key not found");
+            return *value;
+        }
+
+        // 不抛异常、不拷贝的查找：命中返回值的指针（同时更新访问顺序），未命中返回nullptr。
+        // 指针在该条目被淘汰、删除或过期之前有效。
+        template<typename Q>
+        V* find(const Q& key)
+        {
+            [[maybe_unused]] auto sample = m_stats.time_get();
+            auto it = cache_find(m_cache, key);
+            if (it == m_cache.end()) {
+                m_stats.miss();
+                return nullptr;
+            }
+
+            if (isExpired(*it->second)) {
+                erase(it->second);
+                m_stats.evicted(EvictReason::Expired);
+                m_stats.miss();
+                return nullptr;
+            }
+
+            m_lru.splice(m_lru.begin(), m_lru, it->second); // 将节点移动到链表头部
+            m_stats.hit();
+            return &it->second->value;
+        }
+
+        template<typename Q>
+        bool contains(const Q& key)
+        {
+            return find(key) != nullptr;
+        }
+
+        // 条目的剩余存活时间，不改变访问顺序；key不存在、已过期或没有TTL时返回std::nullopt
+        template<typename Q>
+        std::optional<std::chrono::milliseconds> ttl(const Q& key) const
+        {
+            auto it = cache_find(m_cache, key);
+            if (it == m_cache.end() || it->second->expire == NO_EXPIRE) return std::nullopt;
+
+            uint64_t now = m_wheel.now();
+            if (it->second->expire <= now) return std::nullopt;
+            return m_wheel.tick_duration() * (it->second->expire - now);
+        }
+
+        // 批量查找：out[i]为keys[i]对应值的指针，未命中为nullptr，返回命中数。
+        // 每组key分三轮处理：先全部计算哈希并定位桶、预取桶内节点，再在桶内比较key并预取链表节点，
+        // 最后统一检查过期、调整访问顺序，使各个key的缓存未命中互相重叠而不是串行等待。
+        // 已过期的条目按未命中处理（不在这里删除，同一批中可能有重复的key），留给时间轮回收。
+        size_t get_many(const std::vector<K>& keys, std::vector<V*>& out)
+        {
+            out.assign(keys.size(), nullptr);
+            size_t hits = 0;
+            uint64_t now = m_wheel.now();
+
+            for (size_t begin = 0; begin < keys.size(); begin += BATCH_GROUP) {
+                size_t n = std::min(BATCH_GROUP, keys.size() - begin);
+                const K* group = keys.data() + begin;
+                size_t buckets[BATCH_GROUP];
+                NodeIter nodes[BATCH_GROUP];
+                bool found[BATCH_GROUP];
+
+                for (size_t i = 0; i < n; ++i) {
+                    buckets[i] = m_cache.bucket(group[i]);
+                    auto lit = m_cache.begin(buckets[i]);
+                    if (lit != m_cache.end(buckets[i])) cache_prefetch(&*lit);
+                }
+
+                for (size_t i = 0; i < n; ++i) {
+                    found[i] = false;
+                    for (auto lit = m_cache.begin(buckets[i]); lit != m_cache.end(buckets[i]); ++lit) {
+                        if (m_cache.key_eq()(lit->first, group[i])) {
+                            nodes[i] = lit->second;
+                            found[i] = true;
+                            cache_prefetch(&*nodes[i]);
+                            break;
+                        }
+                    }
+                }
+
+                // 调整访问顺序要改写前后相邻节点，先把它们也预取进来
+                for (size_t i = 0; i < n; ++i) {
+                    if (!found[i]) continue;
+                    if (nodes[i] != m_lru.begin()) cache_prefetch(&*std::prev(nodes[i]));
+                    if (std::next(nodes[i]) != m_lru.end()) cache_prefetch(&*std::next(nodes[i]));
+                }
+
+                for (size_t i = 0; i < n; ++i) {
+                    if (!found[i]) continue;
+                    NodeIter node = nodes[i];
+                    if (node->expire != NO_EXPIRE && node->expire <= now) continue;
+
+                    m_lru.splice(m_lru.begin(), m_lru, node);
+                    out[begin + i] = &node->value;
+                    ++hits;
+                }
+            }
+
+            m_stats.hit(hits);
+            m_stats.miss(keys.size() - hits);
+            return hits;
+        }
+
+        // 批量写入：先为整批key预取桶，再逐个写入
+        void put_many(const std::vector<std::pair<K, V>>& items)
+        {
+            for (size_t begin = 0; begin < items.size(); begin += BATCH_GROUP) {
+                size_t n = std::min(BATCH_GROUP, items.size() - begin);
+                for (size_t i = 0; i < n; ++i) {
+                    size_t bucket = m_cache.bucket(items[begin + i].first);
+                    auto lit = m_cache.begin(bucket);
+                    if (lit != m_cache.end(bucket)) cache_prefetch(&*lit);
+                }
+                for (size_t i = 0; i < n; ++i)
+                    put(items[begin + i].first, items[begin + i].second);
+            }
+        }
+
+        // key不存在时用args原地构造值并插入，返回{值的指针, 是否插入}；
+        // key已存在时不构造，只更新访问顺序。条目超过整个预算时返回{nullptr, false}
+        template<typename Q, typename... Args>
+        std::pair<V*, bool> try_emplace(Q&& key, Args&&... args)
+        {
+            if (V* value = find(key)) return {value, false};
+
+            expire();
+            m_lru.emplace_front(std::forward<Q>(key), std::forward<Args>(args)...);
+            NodeIter node = m_lru.begin();
+            if (!admit(node)) return {nullptr, false};
+            return {&node->value, true};
+        }
+
+        // 不带TTL的写入，会清除已有的TTL
+        void put(K key, V value)
+        {
+            putImpl(key, value, NO_EXPIRE);
+        }
+
+        // 带TTL的写入，ttl之后条目失效
+        void put(K key, V value, std::chrono::milliseconds ttl)
+        {
+            // tick 0 表示永不过期，到期时间至少取1
+            putImpl(key, value, std::max<uint64_t>(m_wheel.tick_of(Clock::now() + ttl), 1));
+        }
+
+        // 推进时间轮，回收所有已到期的条目；put时会自动调用，也可以由后台定时调用
+        void expire()
+        {
+            m_wheel.advance(m_wheel.now(), [this](NodeIter node) {
+                node->expire = NO_EXPIRE;     // 定时器已由时间轮释放
+                remove(node);
+                m_stats.evicted(EvictReason::Expired);
+            });
+        }
+
+        // 删除key对应的条目（外部失效通知等场景），返回是否存在
+        template<typename Q>
+        bool erase(const Q& key)
+        {
+            auto it = cache_find(m_cache, key);
+            if (it == m_cache.end()) return false;
+            erase(it->second);
+            return true;
+        }
+
+        // 清空所有条目，统计不清零
+        void clear()
+        {
+            while (!m_lru.empty()) erase(m_lru.begin());
+        }
+
+        size_t size() const { return m_cache.size(); }
+        size_t capacity() const { return m_capacity; }
+
+        // 当前占用和历史峰值（ByteSize下为字节数，EntryCount下为条目数）
+        size_t bytes() const { return m_used; }
+        size_t peak_bytes() const { return m_peak; }
+
+        Stats& stats() { return m_stats; }
+        const Stats& stats() const { return m_stats; }
+
+        // 把当前内容按从最旧到最新的顺序写成快照文件（格式见CacheSnapshot.h），已过期的条目不写入
+        void save(const std::string& path) const
+        {
+            SnapshotWriter out(path);
+            long count_offset = snapshot_detail::write_header<K, V>(out, SnapshotKind::LRU);
+            uint64_t now = m_wheel.now();
+            int64_t now_ms = snapshot_detail::unix_ms_now();
+            uint64_t count = 0;
+
+            for (auto it = m_lru.rbegin(); it != m_lru.rend(); ++it) {
+                if (isExpired(*it)) continue;
+                int64_t expire_ms = it->expire == NO_EXPIRE ? 0 :
+                    now_ms + m_wheel.tick_duration().count() * static_cast<int64_t>(it->expire - now);
+                out.write_pod(expire_ms);
+                SnapshotCodec<K>::write(out, it->key);
+                SnapshotCodec<V>::write(out, it->value);
+                ++count;
+            }
+
+            out.patch_u64(count_offset, count);
+            out.commit();
+        }
+
+        // 通过mmap读取快照并依次写入，恢复原来的访问顺序，返回写入的条目数（不含已经过期的）。
+        // 一般在启动时对空缓存调用；已有的同名key会被覆盖，快照比容量大时最旧的条目被淘汰
+        size_t load(const std::string& path)
+        {
+            SnapshotReader in(path);
+            uint64_t count = snapshot_detail::read_header<K, V>(in, SnapshotKind::LRU);
+            int64_t now_ms = snapshot_detail::unix_ms_now();
+            size_t loaded = 0;
+
+            for (uint64_t i = 0; i < count; ++i) {
+                int64_t expire_ms = in.read_pod<int64_t>();
+                K key = SnapshotCodec<K>::read(in);
+                V value = SnapshotCodec<V>::read(in);
+
+                if (expire_ms == 0) putImpl(key, value, NO_EXPIRE);
+                else if (expire_ms > now_ms) put(key, value, std::chrono::milliseconds(expire_ms - now_ms));
+                else continue;
+                ++loaded;
+            }
+            return loaded;
+        }
+
+        void print()
+        {
+            for (auto& item : m_lru)
+                std::cout << "Key: " << item.key << ", Value: " << item.value << "-> ";
+
+            std::cout<<"nullptr\n";
+        }
+    private:
+        using Clock = std::chrono::steady_clock;
+        static constexpr uint64_t NO_EXPIRE = 0;
+        static constexpr size_t BATCH_GROUP = 16;  // 批量接口每组同时在途的key数
+
+        struct Node;
+        using NodeIter = typename std::list<Node>::iterator;
+        using Wheel = TimingWheel<NodeIter>;
+        using Timer = typename Wheel::Handle;
+
+        struct Node {
+            K key;
+            V value;
+            uint64_t expire;    // 到期tick，NO_EXPIRE表示永不过期
+            Timer timer;        // expire有效时指向时间轮中的定时器
+            template<typename KK, typename... Args>
+            Node(KK&& k, Args&&... args)
+                :key(std::forward<KK>(k)), value(std::forward<Args>(args)...), expire(NO_EXPIRE) {}
+        };
+
+        void putImpl(const K& key, const V& value, uint64_t expire_tick)
+        {
+            [[maybe_unused]] auto sample = m_stats.time_put();
+            expire();
+
+            size_t charge = m_sizer(key, value);
+
+            auto it = m_cache.find(key);
+            if (it != m_cache.end())
+            {
+                NodeIter node = it->second;
+                if (charge > m_capacity) {
+                    // 新值本身就超过了预算，直接移除
+                    erase(node);
+                    m_stats.evicted(EvictReason::Rejected);
+                    return;
+                }
+                m_used = m_used - m_sizer(key, node->value) + charge;
+                node->value = value; // 更新值
+                setExpire(node, expire_tick);
+                m_lru.splice(m_lru.begin(), m_lru, node); // 更新节点位置
+
+                evictUntilFits(0);  // 更新后的元素在头部且不超过预算，不会被淘汰
+                updatePeak();
+                m_stats.updated();
+                return;
+            }
+
+            if (charge > m_capacity) {
+                m_stats.evicted(EvictReason::Rejected);
+                return;
+            }
+
+            // 检查容量是否超出，如果超出则从尾部开始淘汰，直到新元素放得下
+            evictUntilFits(charge);
+
+            // 插入新元素到头部
+            m_lru.emplace_front(key, value);
+            setExpire(m_lru.begin(), expire_tick);
+            m_cache.emplace(key, m_lru.begin());
+            m_used += charge;
+            updatePeak();
+            m_stats.inserted();
+        }
+
+        // 已放在链表头部的新节点计费并加入哈希表；超过整个预算时移除它并返回false
+        bool admit(NodeIter node)
+        {
+            size_t charge = m_sizer(node->key, node->value);
+            if (charge > m_capacity) {
+                m_lru.erase(node);
+                m_stats.evicted(EvictReason::Rejected);
+                return false;
+            }
+
+            m_used += charge;
+            evictUntilFits(0);  // 新节点在头部且不超过预算，不会被淘汰
+            m_cache.emplace(node->key, node);
+            updatePeak();
+            m_stats.inserted();
+            return true;
+        }
+
+        bool isExpired(const Node& node) const
+        {
+            return node.expire != NO_EXPIRE && node.expire <= m_wheel.now();
+        }
+
+        void setExpire(NodeIter node, uint64_t expire_tick)
+        {
+            if (expire_tick == NO_EXPIRE) {
+                if (node->expire != NO_EXPIRE) m_wheel.cancel(node->timer);
+            } else if (node->expire != NO_EXPIRE) {
+                m_wheel.reschedule(node->timer, expire_tick);
+            } else {
+                node->timer = m_wheel.schedule(node, expire_tick);
+            }
+            node->expire = expire_tick;
+        }
+
+        // 删除节点，同时取消它的定时器
+        void erase(NodeIter node)
+        {
+            setExpire(node, NO_EXPIRE);
+            remove(node);
+        }
+
+        // 删除节点，不处理定时器
+        void remove(NodeIter node)
+        {
+            m_used -= m_sizer(node->key, node->value);
+            m_cache.erase(node->key); // 从哈希表中删除该元素
+            m_lru.erase(node);
+        }
+
+        // 淘汰尾部元素，直到再放入charge后不超过容量
+        void evictUntilFits(size_t charge)
+        {
+            while (m_used + charge > m_capacity && !m_lru.empty()) {
+                erase(std::prev(m_lru.end()));
+                m_stats.evicted(EvictReason::Capacity);
+            }
+        }
+
+        void updatePeak() { if (m_used > m_peak) m_peak = m_used; }
+
+        size_t m_capacity;
+        size_t m_used = 0;      // 当前占用
+        size_t m_peak = 0;      // 占用峰值
+        Sizer m_sizer;
+        Stats m_stats;
+        Wheel m_wheel;
+        std::list<Node> m_lru;      //存储键值对，头部最新，尾部最旧
+        std::unordered_map<K, NodeIter, Hash, KeyEqual> m_cache;
+};
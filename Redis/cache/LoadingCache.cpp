@@ -0,0 +1,55 @@
+#include <iostream>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LRU.h"
+#include "LoadingCache.h"
+
+using namespace std;
+
+int main()
+{
+    atomic<int> backend_calls{0};
+
+    // 模拟一次耗时100ms的回源（例如查询MySQL）
+    auto loader = [&](const int& key) {
+        ++backend_calls;
+        this_thread::sleep_for(chrono::milliseconds(100));
+        return "value-" + to_string(key);
+    };
+
+    // 条目存活300ms，剩余不足150ms时后台提前刷新
+    LoadingCache<LRUCache<int, string>> cache(1000, loader,
+        chrono::milliseconds(300), chrono::milliseconds(150));
+
+    // 32个线程同时请求同一个冷key，只会回源一次
+    vector<thread> threads;
+    for (int i = 0; i < 32; ++i)
+        threads.emplace_back([&]() { cache.get(42); });
+    for (auto& t : threads) t.join();
+    cout << "32 concurrent misses -> backend calls: " << backend_calls << endl;
+
+    // 进入提前刷新窗口后的命中直接返回旧值，同时触发一次后台刷新
+    this_thread::sleep_for(chrono::milliseconds(200));
+    cout << "Get key 42: " << cache.get(42) << endl;
+    this_thread::sleep_for(chrono::milliseconds(150));
+    cout << "backend calls after refresh-ahead: " << backend_calls << endl;
+
+    // 刷新后条目的TTL已经续上，此时依然命中
+    cout << "Get key 42: " << cache.get(42) << ", backend calls: " << backend_calls << endl;
+
+    // 回源失败时异常传给调用方，结果不写入缓存
+    LoadingCache<LRUCache<int, string>> failing(10, [](const int& key) -> string {
+        throw runtime_error("backend unavailable for key " + to_string(key));
+    });
+    try {
+        failing.get(7);
+    } catch (const exception& e) {
+        cout << "Loader error: " << e.what() << ", cached entries: " << failing.size() << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+// 自动回源的线程安全缓存，Cache可以是LRUCache或LFUCache：
+//  - get未命中时调用loader回源，并写回缓存
+//  - 同一个key的并发未命中合并成一次回源（single-flight），其余线程等待同一个结果，
+//    避免热点key失效时大量线程同时打到Redis/MySQL
+//  - 可选的提前刷新（refresh-ahead）：命中的条目剩余TTL小于refresh_ahead时，
+//    由后台线程异步重新加载，调用方直接拿到旧值，不用等待
+// loader抛出的异常会传给所有等待该key的线程，结果不会写入缓存。
+template<typename Cache>
+class LoadingCache
+{
+public:
+    using K = typename Cache::key_type;
+    using V = typename Cache::mapped_type;
+    using Loader = std::function<V(const K&)>;
+
+    // ttl为0表示条目不过期；refresh_ahead为0表示不提前刷新
+    LoadingCache(size_t capacity, Loader loader,
+                 std::chrono::milliseconds ttl = std::chrono::milliseconds(0),
+                 std::chrono::milliseconds refresh_ahead = std::chrono::milliseconds(0))
+        :m_cache(capacity), m_loader(std::move(loader)), m_ttl(ttl), m_refresh_ahead(refresh_ahead)
+    {
+        if (m_ttl.count() > 0 && m_refresh_ahead.count() > 0)
+            m_refresher = std::thread(&LoadingCache::refreshLoop, this);
+    }
+
+    ~LoadingCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_refresh_cond.notify_all();
+        if (m_refresher.joinable()) m_refresher.join();
+    }
+
+    LoadingCache(const LoadingCache&) = delete;
+    LoadingCache& operator=(const LoadingCache&) = delete;
+
+    V get(const K& key)
+    {
+        std::shared_future<V> flight;
+        // 只有成为加载者时才建立promise，命中时不分配共享状态
+        std::optional<std::promise<V>> promise;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (V* value = m_cache.find(key)) {
+                if (m_refresher.joinable()) maybeRefresh(key);
+                return *value;
+            }
+
+            // 已经有线程在加载这个key，等待它的结果
+            auto it = m_inflight.find(key);
+            if (it != m_inflight.end()) {
+                flight = it->second;
+            } else {
+                promise.emplace();
+                m_inflight.emplace(key, promise->get_future().share());
+            }
+        }
+
+        if (flight.valid()) return flight.get();
+        return load(key, *promise);
+    }
+
+    // 当前正在回源的key数量
+    size_t inflight() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_inflight.size();
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_cache.size();
+    }
+
+private:
+    // 由发起加载的线程调用：不持锁执行loader，完成后写回缓存并唤醒等待者
+    V load(const K& key, std::promise<V>& promise)
+    {
+        try {
+            V value = m_loader(key);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                store(key, value);
+                m_inflight.erase(key);
+            }
+            promise.set_value(value);
+            return value;
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_inflight.erase(key);
+            }
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+    void store(const K& key, const V& value)
+    {
+        if (m_ttl.count() > 0) m_cache.put(key, value, m_ttl);
+        else m_cache.put(key, value);
+    }
+
+    // 调用时持有m_mutex：剩余TTL不足时把key交给后台线程刷新，同一个key只刷新一次
+    void maybeRefresh(const K& key)
+    {
+        auto remaining = m_cache.ttl(key);
+        if (!remaining || *remaining > m_refresh_ahead) return;
+        if (m_inflight.count(key)) return;
+
+        // 登记为在途加载，刷新期间若条目过期，未命中的线程会等待这次刷新而不是再回源
+        auto promise = std::make_shared<std::promise<V>>();
+        m_inflight.emplace(key, promise->get_future().share());
+        m_refresh_queue.emplace(key, std::move(promise));
+        m_refresh_cond.notify_one();
+    }
+
+    void refreshLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_refresh_cond.wait(lock, [this]() { return m_stop || !m_refresh_queue.empty(); });
+            if (m_stop) break;
+
+            auto task = std::move(m_refresh_queue.front());
+            m_refresh_queue.pop();
+
+            lock.unlock();
+            try {
+                load(task.first, *task.second);
+            } catch (...) {
+                // 刷新失败保留旧值，等它自然过期后由get重新回源
+            }
+            lock.lock();
+        }
+
+        // 退出前让还在等待刷新结果的线程收到异常，而不是永远阻塞
+        while (!m_refresh_queue.empty()) {
+            auto& task = m_refresh_queue.front();
+            m_inflight.erase(task.first);
+            task.second->set_exception(std::make_exception_ptr(std::runtime_error("LoadingCache stopped")));
+            m_refresh_queue.pop();
+        }
+    }
+
+    mutable std::mutex m_mutex;                 // 保护缓存、在途表和刷新队列
+    Cache m_cache;
+    Loader m_loader;
+    std::chrono::milliseconds m_ttl;
+    std::chrono::milliseconds m_refresh_ahead;
+    std::unordered_map<K, std::shared_future<V>> m_inflight;    // 正在回源的key
+    std::queue<std::pair<K, std::shared_ptr<std::promise<V>>>> m_refresh_queue;
+    std::condition_variable m_refresh_cond;
+    bool m_stop = false;
+    std::thread m_refresher;
+};
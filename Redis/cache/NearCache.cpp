@@ -0,0 +1,72 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "NearCache.h"
+
+using namespace std;
+
+// 需要本地运行的redis-server（6.0及以上）：./near_cache [host] [port] [password]
+int main(int argc, char* argv[])
+{
+    const string host = argc > 1 ? argv[1] : "127.0.0.1";
+    const int port = argc > 2 ? stoi(argv[2]) : 6379;
+    const string password = argc > 3 ? argv[3] : "";
+    const int KEYS = 1000;
+    const int READS = 100000;
+
+    try {
+        NearCache<> cache(host, port, password, 10000);
+
+        for (int i = 0; i < KEYS; ++i) cache.set("near:" + to_string(i), "value-" + to_string(i));
+
+        // 偏斜的读：大部分访问落在少数热点key上
+        mt19937 gen(7);
+        geometric_distribution<int> skew(0.01);
+        vector<string> keys;
+        for (int i = 0; i < READS; ++i) keys.push_back("near:" + to_string(skew(gen) % KEYS));
+
+        auto begin = chrono::steady_clock::now();
+        for (const string& key : keys) cache.get(key);
+        double near_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / READS;
+
+        // 对照：同样的访问全部直接GET Redis
+        redisContext* raw = redisConnect(host.c_str(), port);
+        if (raw == nullptr || raw->err) throw runtime_error("cannot connect to redis");
+        if (!password.empty()) freeReplyObject(redisCommand(raw, "AUTH %s", password.c_str()));
+
+        begin = chrono::steady_clock::now();
+        for (const string& key : keys) freeReplyObject(redisCommand(raw, "GET %b", key.data(), key.size()));
+        double redis_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / READS;
+
+        auto s = cache.stats();
+        cout << "near cache: " << near_ns << " ns/get, L1 hits " << s.l1_hits << ", L2 hits " << s.l2_hits
+             << ", local entries " << cache.local_size() << endl;
+        cout << "redis only: " << redis_ns << " ns/get" << endl;
+
+        // 其他客户端修改key后，失效通知删除L1副本，下一次读拿到新值
+        cache.get("near:1");
+        freeReplyObject(redisCommand(raw, "SET near:1 changed"));
+        begin = chrono::steady_clock::now();
+        while (cache.get("near:1") != "changed" && chrono::steady_clock::now() - begin < chrono::seconds(1))
+            this_thread::sleep_for(chrono::microseconds(50));
+        auto us = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - begin).count();
+        cout << "external SET near:1 -> get returns " << *cache.get("near:1") << " after " << us << " us" << endl;
+
+        // FLUSHDB的通知清空整个L1
+        freeReplyObject(redisCommand(raw, "FLUSHDB"));
+        this_thread::sleep_for(chrono::milliseconds(50));
+        cout << "after FLUSHDB: local entries " << cache.local_size()
+             << ", near:1 exists " << cache.get("near:1").has_value()
+             << ", invalidations received " << cache.stats().invalidations << endl;
+
+        redisFree(raw);
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
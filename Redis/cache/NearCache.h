@@ -0,0 +1,420 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <sys/socket.h>
+#include <hiredis/hiredis.h>
+
+#include "LRU.h"
+
+// 两级缓存：进程内的LRUCache做L1，Redis做L2。线程安全。
+//  - get先查L1，未命中再GET Redis并回填L1；set/del直接写Redis，同时删除L1中的副本
+//  - 失效通知用Redis 6的客户端缓存（client-side caching）：数据连接执行
+//    CLIENT TRACKING on REDIRECT <订阅连接的id>，Redis记住这个连接读过的key，
+//    这些key被任何客户端修改、删除、过期或淘汰时，向订阅连接推送 __redis__:invalidate 消息，
+//    后台线程收到后删除L1中的对应条目。用RESP2的重定向模式，同步的hiredis接口就能收到通知
+//  - 订阅连接断开期间收不到通知，L1清空并停用（读直接走Redis），重连成功后重新开启跟踪；
+//    数据连接重连后新连接没有读过任何key，同样要清空L1。订阅连接断开期间数据连接重连时不开启跟踪，
+//    照常读写Redis，等订阅连接重连后再开启
+//  - l1_ttl大于0时L1条目额外带TTL，作为通知丢失时的兜底
+// 回填与失效的竞争：GET返回之后、回填之前，这个key可能已经被修改并且通知已经处理完，
+// 直接回填会把旧值留在L1里。所以GET之前先登记，通知线程把登记过的key标记为失效，回填时发现失效就放弃。
+// Sizer决定L1容量的计量方式，同LRUCache。
+template<typename Sizer = EntryCount>
+class NearCache
+{
+public:
+    struct Stats {
+        uint64_t l1_hits = 0;           // 本地命中
+        uint64_t l2_hits = 0;           // L1未命中、Redis中存在
+        uint64_t misses = 0;            // Redis中也不存在
+        uint64_t invalidations = 0;     // 收到的失效key数（清空整个L1计1次）
+    };
+
+    NearCache(const std::string& host, int port, const std::string& password,
+              size_t capacity, std::chrono::milliseconds l1_ttl = std::chrono::milliseconds(0))
+        :m_host(host), m_port(port), m_password(password), m_l1_ttl(l1_ttl), m_l1(capacity)
+    {
+        m_data = connect();
+        long long id = 0;
+        m_sub = subscribe(id);
+        if (!enableTracking(id)) throw std::runtime_error("CLIENT TRACKING failed (requires Redis 6+)");
+        m_listener = std::thread(&NearCache::listenLoop, this);
+    }
+
+    ~NearCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sub_mutex);
+            m_stop = true;
+            // 关闭订阅连接的socket，让阻塞在redisGetReply上的后台线程返回
+            if (m_sub) ::shutdown(m_sub->fd, SHUT_RDWR);
+        }
+        m_stop_cond.notify_all();
+        if (m_listener.joinable()) m_listener.join();
+    }
+
+    NearCache(const NearCache&) = delete;
+    NearCache& operator=(const NearCache&) = delete;
+
+    // key不存在时返回std::nullopt；Redis出错时抛出std::runtime_error
+    std::optional<std::string> get(const std::string& key)
+    {
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_tracking) {
+                if (std::string* value = m_l1.find(key)) {
+                    m_l1_hits.fetch_add(1, std::memory_order_relaxed);
+                    return *value;
+                }
+            }
+            generation = m_generation;
+            ++m_pending[key].readers;
+        }
+
+        std::optional<std::string> value;
+        try {
+            value = fetch(key);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            unregister(key);
+            throw;
+        }
+
+        (value ? m_l2_hits : m_misses).fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // 期间L1被清空过（重连、FLUSHALL）或者这个key收到过失效通知，读到的值可能已经过时，不回填
+        if (value && m_tracking && generation == m_generation && !m_pending[key].stale) {
+            if (m_l1_ttl.count() > 0) m_l1.put(key, *value, m_l1_ttl);
+            else m_l1.put(key, *value);
+        }
+        unregister(key);
+        return value;
+    }
+
+    // 写穿到Redis，ttl大于0时带过期时间（PX）
+    void set(const std::string& key, const std::string& value,
+             std::chrono::milliseconds ttl = std::chrono::milliseconds(0))
+    {
+        if (ttl.count() > 0) {
+            std::string ms = std::to_string(ttl.count());
+            const char* argv[] = {"SET", key.data(), value.data(), "PX", ms.data()};
+            size_t lens[] = {3, key.size(), value.size(), 2, ms.size()};
+            command(5, argv, lens);
+        } else {
+            const char* argv[] = {"SET", key.data(), value.data()};
+            size_t lens[] = {3, key.size(), value.size()};
+            command(3, argv, lens);
+        }
+        invalidateLocal(key);
+    }
+
+    // 删除Redis中的key，返回是否存在
+    bool del(const std::string& key)
+    {
+        const char* argv[] = {"DEL", key.data()};
+        size_t lens[] = {3, key.size()};
+        Reply reply = command(2, argv, lens);
+        invalidateLocal(key);
+        return reply->integer > 0;
+    }
+
+    // L1当前条目数
+    size_t local_size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_l1.size();
+    }
+
+    // 失效通知是否正常，为false时所有读都直接走Redis
+    bool tracking() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_tracking;
+    }
+
+    Stats stats() const
+    {
+        Stats s;
+        s.l1_hits = m_l1_hits.load(std::memory_order_relaxed);
+        s.l2_hits = m_l2_hits.load(std::memory_order_relaxed);
+        s.misses = m_misses.load(std::memory_order_relaxed);
+        s.invalidations = m_invalidations.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    struct ContextDeleter {
+        void operator()(redisContext* c) const { redisFree(c); }
+    };
+    struct ReplyDeleter {
+        void operator()(redisReply* r) const { freeReplyObject(r); }
+    };
+    using Context = std::unique_ptr<redisContext, ContextDeleter>;
+    using Reply = std::unique_ptr<redisReply, ReplyDeleter>;
+
+    // 正在回源的key：回源期间收到失效通知时stale置位，回填时放弃
+    struct Pending {
+        int readers = 0;
+        bool stale = false;
+    };
+
+    static constexpr std::chrono::milliseconds RECONNECT_MIN{100};
+    static constexpr std::chrono::milliseconds RECONNECT_MAX{5000};
+
+    Context connect() const
+    {
+        struct timeval timeout = {1, 500000};   // 连接和命令超时都是1.5秒
+        redisOptions options;
+        std::memset(&options, 0, sizeof(options));
+        REDIS_OPTIONS_SET_TCP(&options, m_host.c_str(), m_port);
+        options.connect_timeout = &timeout;
+        options.command_timeout = &timeout;
+
+        Context c(redisConnectWithOptions(&options));
+        if (!c) throw std::runtime_error("cannot allocate redis context");
+        if (c->err) throw std::runtime_error(std::string("redis connect: ") + c->errstr);
+
+        if (!m_password.empty()) {
+            Reply reply(static_cast<redisReply*>(redisCommand(c.get(), "AUTH %b", m_password.data(), m_password.size())));
+            if (!reply || reply->type == REDIS_REPLY_ERROR) throw std::runtime_error("redis AUTH failed");
+        }
+        return c;
+    }
+
+    // 建立订阅连接：取得它的client id后订阅失效频道。订阅连接不设命令超时，一直阻塞等待消息
+    Context subscribe(long long& id) const
+    {
+        Context c = connect();
+        Reply reply(static_cast<redisReply*>(redisCommand(c.get(), "CLIENT ID")));
+        if (!reply || reply->type != REDIS_REPLY_INTEGER) throw std::runtime_error("CLIENT ID failed");
+        id = reply->integer;
+
+        reply.reset(static_cast<redisReply*>(redisCommand(c.get(), "SUBSCRIBE __redis__:invalidate")));
+        if (!reply || reply->type != REDIS_REPLY_ARRAY) throw std::runtime_error("SUBSCRIBE failed");
+
+        struct timeval forever = {0, 0};
+        redisSetTimeout(c.get(), forever);
+        return c;
+    }
+
+    // 在数据连接上开启跟踪，通知重定向到订阅连接；成功后清空L1并启用
+    bool enableTracking(long long sub_id)
+    {
+        std::lock_guard<std::mutex> redis_lock(m_redis_mutex);
+        m_sub_id = sub_id;
+        if (!m_data && !reconnectData()) return false;
+        return m_tracking_on_data || trackOn();
+    }
+
+    // 订阅连接断开：它的client id随之失效，清除后数据连接重连时不再用它开启跟踪
+    void subscriberLost()
+    {
+        std::lock_guard<std::mutex> redis_lock(m_redis_mutex);
+        m_sub_id = 0;
+        m_tracking_on_data = false;
+        resetL1(false);
+    }
+
+    // 持有m_redis_mutex调用
+    bool trackOn()
+    {
+        std::string cmd = "CLIENT TRACKING on REDIRECT " + std::to_string(m_sub_id);
+        Reply reply(static_cast<redisReply*>(redisCommand(m_data.get(), cmd.c_str())));
+        if (!reply || reply->type == REDIS_REPLY_ERROR) {
+            if (!reply) m_data.reset();
+            return false;
+        }
+        m_tracking_on_data = true;
+        resetL1(true);
+        return true;
+    }
+
+    // 持有m_redis_mutex调用：数据连接断开后重连，并在新连接上重新开启跟踪。
+    // 返回数据连接是否可用；跟踪开启失败（订阅连接恰好断开，id已失效）时L1保持停用，命令照常执行
+    bool reconnectData()
+    {
+        resetL1(false);
+        m_tracking_on_data = false;
+        try {
+            m_data = connect();
+        } catch (std::exception&) {
+            m_data.reset();
+            return false;
+        }
+        if (m_sub_id != 0) trackOn();
+        return m_data != nullptr;
+    }
+
+    // 在数据连接上执行命令，Redis返回错误时抛出异常。连接出错后不能再用，丢弃后下次重连
+    Reply command(int argc, const char** argv, const size_t* lens)
+    {
+        std::lock_guard<std::mutex> redis_lock(m_redis_mutex);
+        if (!m_data && !reconnectData()) throw std::runtime_error("redis unavailable");
+
+        Reply reply(static_cast<redisReply*>(redisCommandArgv(m_data.get(), argc, argv, lens)));
+        if (!reply) {
+            std::string err = m_data->errstr;
+            m_data.reset();
+            resetL1(false);
+            throw std::runtime_error("redis: " + err);
+        }
+        if (reply->type == REDIS_REPLY_ERROR) throw std::runtime_error(std::string("redis: ") + reply->str);
+        return reply;
+    }
+
+    std::optional<std::string> fetch(const std::string& key)
+    {
+        const char* argv[] = {"GET", key.data()};
+        size_t lens[] = {3, key.size()};
+        Reply reply = command(2, argv, lens);
+        if (reply->type != REDIS_REPLY_STRING) return std::nullopt;
+        return std::string(reply->str, reply->len);
+    }
+
+    // 清空L1并使正在回源的读取作废；tracking表示之后L1是否可用
+    void resetL1(bool tracking)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_l1.clear();
+        ++m_generation;
+        m_tracking = tracking;
+    }
+
+    void invalidateLocal(const std::string& key)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_l1.erase(key);
+        auto it = m_pending.find(key);
+        if (it != m_pending.end()) it->second.stale = true;
+    }
+
+    // 持有m_mutex调用
+    void unregister(const std::string& key)
+    {
+        auto it = m_pending.find(key);
+        if (--it->second.readers == 0) m_pending.erase(it);
+    }
+
+    // 处理一条订阅消息：["message", "__redis__:invalidate", [key...]]，第三项为nil表示FLUSHALL/FLUSHDB
+    void onMessage(const redisReply* reply)
+    {
+        if (reply->type != REDIS_REPLY_ARRAY || reply->elements != 3) return;
+        const redisReply* kind = reply->element[0];
+        if (kind->type != REDIS_REPLY_STRING || std::string(kind->str, kind->len) != "message") return;
+
+        const redisReply* payload = reply->element[2];
+        if (payload->type == REDIS_REPLY_ARRAY) {
+            for (size_t i = 0; i < payload->elements; ++i) {
+                const redisReply* key = payload->element[i];
+                if (key->type != REDIS_REPLY_STRING) continue;
+                invalidateLocal(std::string(key->str, key->len));
+                m_invalidations.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else if (payload->type == REDIS_REPLY_STRING) {
+            // 单个key时部分版本直接发送字符串
+            invalidateLocal(std::string(payload->str, payload->len));
+            m_invalidations.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_l1.clear();
+            ++m_generation;
+            m_invalidations.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // 后台线程：阻塞读取失效通知；连接断开时停用L1，按指数退避重连
+    void listenLoop()
+    {
+        std::chrono::milliseconds backoff = RECONNECT_MIN;
+        for (;;) {
+            redisContext* sub;
+            {
+                std::lock_guard<std::mutex> lock(m_sub_mutex);
+                if (m_stop) return;
+                sub = m_sub.get();
+            }
+
+            if (sub != nullptr) {
+                void* raw = nullptr;
+                if (redisGetReply(sub, &raw) == REDIS_OK) {
+                    Reply reply(static_cast<redisReply*>(raw));
+                    onMessage(reply.get());
+                    continue;
+                }
+
+                // 连接断开：通知可能已经丢失，L1中的任何条目都不可信
+                subscriberLost();
+                std::lock_guard<std::mutex> lock(m_sub_mutex);
+                if (m_stop) return;
+                m_sub.reset();
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(m_sub_mutex);
+                if (m_stop_cond.wait_for(lock, backoff, [this] { return m_stop; })) return;
+            }
+
+            try {
+                long long id = 0;
+                Context fresh = subscribe(id);
+                {
+                    std::lock_guard<std::mutex> lock(m_sub_mutex);
+                    if (m_stop) return;
+                    m_sub = std::move(fresh);
+                }
+                if (enableTracking(id)) {
+                    backoff = RECONNECT_MIN;
+                    continue;
+                }
+                subscriberLost();
+                std::lock_guard<std::mutex> lock(m_sub_mutex);
+                m_sub.reset();
+            } catch (std::exception&) {
+            }
+            backoff = std::min(backoff * 2, RECONNECT_MAX);
+        }
+    }
+
+    const std::string m_host;
+    const int m_port;
+    const std::string m_password;
+    const std::chrono::milliseconds m_l1_ttl;
+
+    // 数据连接，所有Redis命令串行使用；加锁顺序固定为先m_redis_mutex后m_mutex
+    std::mutex m_redis_mutex;
+    Context m_data;
+    long long m_sub_id = 0;             // 订阅连接的client id，0表示订阅连接断开
+    bool m_tracking_on_data = false;    // 数据连接上是否已经重定向到m_sub_id
+
+    // L1及回源登记
+    mutable std::mutex m_mutex;
+    LRUCache<std::string, std::string, Sizer> m_l1;
+    std::unordered_map<std::string, Pending> m_pending;
+    uint64_t m_generation = 0;      // 每次整体清空L1时加1
+    bool m_tracking = false;
+
+    // 订阅连接，由后台线程使用
+    std::mutex m_sub_mutex;
+    std::condition_variable m_stop_cond;
+    Context m_sub;
+    bool m_stop = false;
+    std::thread m_listener;
+
+    std::atomic<uint64_t> m_l1_hits{0};
+    std::atomic<uint64_t> m_l2_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+    std::atomic<uint64_t> m_invalidations{0};
+};
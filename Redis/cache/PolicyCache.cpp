@@ -0,0 +1,88 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <thread>
+#include <chrono>
+
+#include "PolicyCache.h"
+
+using namespace std;
+
+// 热点集合 + 循环扫描：扫描长度略大于缓存，LRU会被冲刷，ARC/2Q能保住热点
+vector<int> make_trace(size_t length, size_t hot_keys, size_t scan_keys)
+{
+    mt19937 gen(11);
+    uniform_int_distribution<int> hot(0, hot_keys - 1);
+
+    vector<int> trace;
+    trace.reserve(length);
+    int scan = 0;
+    while (trace.size() < length) {
+        for (int i = 0; i < 3 && trace.size() < length; ++i) trace.push_back(hot(gen));
+        trace.push_back(hot_keys + (scan++ % scan_keys));
+    }
+    return trace;
+}
+
+template<typename Cache>
+double hit_ratio(Cache& cache, const vector<int>& trace)
+{
+    size_t hits = 0;
+    for (int key : trace) {
+        try {
+            cache.get(key);
+            ++hits;
+        } catch (out_of_range&) {
+            cache.put(key, key);
+        }
+    }
+    return static_cast<double>(hits) / trace.size();
+}
+
+// 热点集合在两个阶段之间整体切换，每个阶段还混入1/4的一次性key
+vector<int> make_phase(size_t length, int hot_base, size_t hot_keys, mt19937& gen)
+{
+    uniform_int_distribution<int> hot(0, hot_keys - 1);
+    vector<int> trace;
+    trace.reserve(length);
+    int once = 1000000 + hot_base * 1000;
+    for (size_t i = 0; i < length; ++i)
+        trace.push_back(i % 4 == 3 ? once++ : hot_base + hot(gen));
+    return trace;
+}
+
+int main()
+{
+    vector<int> trace = make_trace(400000, 500, 5000);
+
+    cout << "capacity, LRU, LFU, ARC, 2Q\n";
+    for (size_t capacity : {250, 500, 1000, 2000}) {
+        PolicyCache<int, int, LRUPolicy> lru(capacity);
+        PolicyCache<int, int, LFUPolicy> lfu(capacity);
+        PolicyCache<int, int, ARCPolicy> arc(capacity);
+        PolicyCache<int, int, TwoQPolicy> twoq(capacity);
+
+        cout << capacity << ", " << hit_ratio(lru, trace) << ", " << hit_ratio(lfu, trace)
+             << ", " << hit_ratio(arc, trace) << ", " << hit_ratio(twoq, trace) << "\n";
+    }
+
+    // 热点切换：LFU里旧热点的计数永远不会下降，新热点很难挤进来；
+    // Redis风格LFU的计数器随空闲时间衰减（这里衰减周期取10ms），旧热点会被逐渐淘汰
+    mt19937 gen(5);
+    vector<int> before = make_phase(400000, 0, 800, gen);
+    vector<int> after = make_phase(200000, 5000, 800, gen);
+
+    PolicyCache<int, int, LRUPolicy> lru(1000);
+    PolicyCache<int, int, LFUPolicy> lfu(1000);
+    PolicyCache<int, int, RedisLFUPolicy> redis_lfu(1000, chrono::milliseconds(10));
+    hit_ratio(lru, before);
+    hit_ratio(lfu, before);
+    hit_ratio(redis_lfu, before);
+    this_thread::sleep_for(chrono::milliseconds(100));
+
+    cout << "\nhit ratio after the hot set moves: LRU, LFU, Redis LFU\n";
+    cout << hit_ratio(lru, after) << ", " << hit_ratio(lfu, after) << ", " << hit_ratio(redis_lfu, after) << "\n";
+
+    return 0;
+}
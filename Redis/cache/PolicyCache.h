@@ -0,0 +1,527 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// 淘汰策略作为模板参数的缓存：值存放在缓存自己的哈希表里，策略只维护key的排序，
+// 编译期选定策略，热路径上没有虚函数调用。
+//
+// 策略类 Policy<K> 需要提供：
+//   using Handle;                              驻留元素在策略中的句柄（迭代器，splice后保持有效）
+//   Policy(size_t capacity, ...);                  构造PolicyCache时多出的参数原样传给策略
+//   Handle insert(const K& key, uint64_t hash);    新元素进入缓存
+//   void touch(Handle h);                          元素被命中
+//   Handle victim(uint64_t incoming_hash);         缓存已满时选出要淘汰的元素
+//   void evict(Handle h);                          移除victim()选出的元素
+//   const K& key(Handle h) const;
+template<typename K, typename V, template<typename> class Policy, typename Hash = std::hash<K>>
+class PolicyCache
+{
+public:
+    template<typename... PolicyArgs>
+    explicit PolicyCache(size_t capacity, PolicyArgs&&... args)
+        :m_capacity(capacity), m_policy(capacity, std::forward<PolicyArgs>(args)...) {}
+
+    V get(K key)
+    {
+        V* value = find(key);
+        if (value == nullptr) throw std::out_of_range("Key not found");
+        return *value;
+    }
+
+    // 不抛异常的查找：命中返回值的指针，未命中返回nullptr
+    V* find(const K& key)
+    {
+        auto it = m_cache.find(key);
+        if (it == m_cache.end()) return nullptr;
+
+        m_policy.touch(it->second.handle);
+        return &it->second.value;
+    }
+
+    void put(K key, V value)
+    {
+        if (m_capacity == 0) return;
+
+        auto it = m_cache.find(key);
+        if (it != m_cache.end()) {
+            it->second.value = value;
+            m_policy.touch(it->second.handle);
+            return;
+        }
+
+        uint64_t hash = hash_of(key);
+        if (m_cache.size() >= m_capacity) {
+            auto victim = m_policy.victim(hash);
+            m_cache.erase(m_policy.key(victim));
+            m_policy.evict(victim);
+        }
+
+        m_cache.emplace(key, Entry{value, m_policy.insert(key, hash)});
+    }
+
+    size_t size() const { return m_cache.size(); }
+    size_t capacity() const { return m_capacity; }
+
+private:
+    struct Entry {
+        V value;
+        typename Policy<K>::Handle handle;
+    };
+
+    uint64_t hash_of(const K& key) const
+    {
+        uint64_t h = m_hasher(key);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    size_t m_capacity;
+    Policy<K> m_policy;
+    std::unordered_map<K, Entry, Hash> m_cache;
+    Hash m_hasher;
+};
+
+// LRU：一条链表，头部最新
+template<typename K>
+class LRUPolicy
+{
+public:
+    using Handle = typename std::list<K>::iterator;
+
+    LRUPolicy(size_t) {}
+
+    Handle insert(const K& key, uint64_t)
+    {
+        m_lru.push_front(key);
+        return m_lru.begin();
+    }
+
+    void touch(Handle h) { m_lru.splice(m_lru.begin(), m_lru, h); }
+
+    Handle victim(uint64_t) { return std::prev(m_lru.end()); }
+
+    void evict(Handle h) { m_lru.erase(h); }
+
+    const K& key(Handle h) const { return *h; }
+
+private:
+    std::list<K> m_lru;
+};
+
+// LFU：与LFUCache相同的频率桶结构，命中时把节点splice到下一个频率桶
+template<typename K>
+class LFUPolicy
+{
+    struct Node;
+    struct Bucket {
+        size_t freq;
+        std::list<Node> nodes;
+        explicit Bucket(size_t f) :freq(f) {}
+    };
+    using BucketIter = typename std::list<Bucket>::iterator;
+    struct Node {
+        K key;
+        BucketIter bucket;
+        Node(const K& k, BucketIter b) :key(k), bucket(b) {}
+    };
+
+public:
+    using Handle = typename std::list<Node>::iterator;
+
+    LFUPolicy(size_t) {}
+
+    Handle insert(const K& key, uint64_t)
+    {
+        if (m_buckets.empty() || m_buckets.front().freq != 1) m_buckets.emplace_front(1);
+        BucketIter first = m_buckets.begin();
+        first->nodes.emplace_front(key, first);
+        return first->nodes.begin();
+    }
+
+    void touch(Handle h)
+    {
+        BucketIter cur = h->bucket;
+        BucketIter next = std::next(cur);
+        if (next == m_buckets.end() || next->freq != cur->freq + 1)
+            next = m_buckets.emplace(next, cur->freq + 1);
+
+        next->nodes.splice(next->nodes.begin(), cur->nodes, h);
+        h->bucket = next;
+        if (cur->nodes.empty()) m_buckets.erase(cur);
+    }
+
+    // 最小频率桶中最旧的节点
+    Handle victim(uint64_t) { return std::prev(m_buckets.front().nodes.end()); }
+
+    void evict(Handle h)
+    {
+        BucketIter bucket = h->bucket;
+        bucket->nodes.erase(h);
+        if (bucket->nodes.empty()) m_buckets.erase(bucket);
+    }
+
+    const K& key(Handle h) const { return h->key; }
+
+private:
+    std::list<Bucket> m_buckets;    // 按频率升序
+};
+
+// Redis风格的近似LFU（maxmemory-policy allkeys-lfu）：
+//  - 每个元素只有8位对数计数器和16位的上次衰减时间。计数器越大，访问时加一的概率越低
+//    （1 / ((counter - LFU_INIT_VAL) * log_factor + 1)），log_factor=10时255约对应百万次访问
+//  - 新元素的计数器从LFU_INIT_VAL开始，避免刚插入就因为计数为0被淘汰
+//  - 计数器按空闲时间衰减：每空闲一个decay_period减一，曾经的热点不再被访问后会逐渐变冷
+//  - 不维护全局有序结构：淘汰时随机抽样samples个元素，选衰减后计数器最小的一个
+// 元素放在slab数组中，Handle是slab下标；另有一个稠密下标数组用于随机抽样，删除时与末尾交换。
+// 稳定运行时插入、淘汰都不做堆分配。
+template<typename K>
+class RedisLFUPolicy
+{
+    struct Node {
+        K key;
+        uint32_t pos;       // 在m_dense中的下标
+        uint16_t ldt;       // 上次衰减时间，以decay_period为单位，允许回绕
+        uint8_t counter;    // 对数计数器
+    };
+    using Clock = std::chrono::steady_clock;
+
+public:
+    using Handle = uint32_t;
+    static constexpr uint8_t LFU_INIT_VAL = 5;
+    static constexpr uint8_t LFU_MAX = 255;
+
+    RedisLFUPolicy(size_t capacity,
+                   std::chrono::milliseconds decay_period = std::chrono::minutes(1),
+                   unsigned log_factor = 10, unsigned samples = 5)
+        :m_decay_ms(std::max<int64_t>(decay_period.count(), 1)), m_log_factor(log_factor),
+         m_samples(std::max(samples, 1u)), m_epoch(Clock::now())
+    {
+        m_nodes.reserve(capacity);
+        m_dense.reserve(capacity);
+    }
+
+    Handle insert(const K& key, uint64_t)
+    {
+        Handle h;
+        if (!m_free.empty()) {
+            h = m_free.back();
+            m_free.pop_back();
+            m_nodes[h].key = key;
+        } else {
+            h = static_cast<Handle>(m_nodes.size());
+            m_nodes.push_back(Node{key, 0, 0, 0});
+        }
+
+        Node& node = m_nodes[h];
+        node.pos = static_cast<uint32_t>(m_dense.size());
+        node.ldt = period();
+        node.counter = LFU_INIT_VAL;
+        m_dense.push_back(h);
+        return h;
+    }
+
+    // 先按空闲时间衰减，再按概率加一
+    void touch(Handle h)
+    {
+        Node& node = m_nodes[h];
+        uint16_t now = period();
+        node.counter = logIncr(decayed(node, now));
+        node.ldt = now;
+    }
+
+    Handle victim(uint64_t)
+    {
+        uint16_t now = period();
+        Handle best = m_dense[nextRandom() % m_dense.size()];
+        uint8_t best_counter = decayed(m_nodes[best], now);
+        for (unsigned i = 1; i < m_samples && best_counter > 0; ++i) {
+            Handle h = m_dense[nextRandom() % m_dense.size()];
+            uint8_t counter = decayed(m_nodes[h], now);
+            if (counter < best_counter) {
+                best = h;
+                best_counter = counter;
+            }
+        }
+        return best;
+    }
+
+    void evict(Handle h)
+    {
+        // 与末尾交换后删除，被移动元素的pos同步更新
+        Handle last = m_dense.back();
+        m_dense[m_nodes[h].pos] = last;
+        m_nodes[last].pos = m_nodes[h].pos;
+        m_dense.pop_back();
+        m_free.push_back(h);
+    }
+
+    const K& key(Handle h) const { return m_nodes[h].key; }
+
+    // 衰减后的计数器，不修改元素
+    uint8_t frequency(Handle h) const { return decayed(m_nodes[h], period()); }
+
+private:
+    uint16_t period() const
+    {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - m_epoch).count();
+        return static_cast<uint16_t>(ms / m_decay_ms);
+    }
+
+    static uint8_t decayed(const Node& node, uint16_t now)
+    {
+        uint16_t idle = static_cast<uint16_t>(now - node.ldt);
+        return node.counter > idle ? static_cast<uint8_t>(node.counter - idle) : 0;
+    }
+
+    uint8_t logIncr(uint8_t counter)
+    {
+        if (counter == LFU_MAX) return counter;
+        double r = (nextRandom() >> 11) * (1.0 / 9007199254740992.0);  // [0, 1)
+        double base = counter > LFU_INIT_VAL ? counter - LFU_INIT_VAL : 0;
+        return r < 1.0 / (base * m_log_factor + 1) ? counter + 1 : counter;
+    }
+
+    uint64_t nextRandom()
+    {
+        // xorshift64*
+        m_rand ^= m_rand >> 12;
+        m_rand ^= m_rand << 25;
+        m_rand ^= m_rand >> 27;
+        return m_rand * 0x2545f4914f6cdd1dULL;
+    }
+
+    int64_t m_decay_ms;
+    unsigned m_log_factor;
+    unsigned m_samples;
+    Clock::time_point m_epoch;
+    uint64_t m_rand = 0x9e3779b97f4a7c15ULL;
+    std::vector<Node> m_nodes;      // slab，Handle为下标
+    std::vector<Handle> m_dense;    // 驻留元素的下标，用于随机抽样
+    std::vector<Handle> m_free;     // slab中的空闲位置
+};
+
+// ARC（Adaptive Replacement Cache）：
+//  - T1：只访问过一次的驻留元素，T2：访问过至少两次的驻留元素
+//  - B1/B2：刚从T1/T2淘汰的幽灵记录，只保存key的哈希值，内存有界
+//  - 命中B1说明T1偏小，增大目标值p；命中B2则减小p，据此在T1和T2之间自适应分配容量
+template<typename K>
+class ARCPolicy
+{
+    enum ListId : uint8_t { T1, T2 };
+    struct Node {
+        K key;
+        uint64_t hash;
+        ListId list;
+        Node(const K& k, uint64_t h, ListId l) :key(k), hash(h), list(l) {}
+    };
+    using GhostIter = std::list<uint64_t>::iterator;
+    struct Ghost {
+        ListId list;        // 来自T1为B1，来自T2为B2
+        GhostIter pos;
+    };
+
+public:
+    using Handle = typename std::list<Node>::iterator;
+
+    ARCPolicy(size_t capacity) :m_capacity(capacity) {}
+
+    Handle insert(const K& key, uint64_t hash)
+    {
+        auto ghost = m_ghosts.find(hash);
+        if (ghost != m_ghosts.end()) {
+            // 幽灵命中：调整p（victim()中可能已经调整过），然后直接进入T2
+            if (!m_adapted || m_adapted_hash != hash) adapt(ghost->second.list);
+            ghostList(ghost->second.list).erase(ghost->second.pos);
+            m_ghosts.erase(ghost);
+            m_adapted = false;
+
+            m_t2.emplace_front(key, hash, T2);
+            return m_t2.begin();
+        }
+        m_adapted = false;
+
+        // 全新元素：维持 |T1|+|B1| <= c 且总记录数 <= 2c
+        if (m_t1.size() + m_b1.size() >= m_capacity && !m_b1.empty())
+            dropGhost(m_b1);
+        else if (m_t1.size() + m_t2.size() + m_b1.size() + m_b2.size() >= 2 * m_capacity && !m_b2.empty())
+            dropGhost(m_b2);
+
+        m_t1.emplace_front(key, hash, T1);
+        return m_t1.begin();
+    }
+
+    void touch(Handle h)
+    {
+        if (h->list == T1) {
+            h->list = T2;
+            m_t2.splice(m_t2.begin(), m_t1, h);
+        } else {
+            m_t2.splice(m_t2.begin(), m_t2, h);
+        }
+    }
+
+    Handle victim(uint64_t incoming_hash)
+    {
+        bool in_b2 = false;
+        auto ghost = m_ghosts.find(incoming_hash);
+        if (ghost != m_ghosts.end()) {
+            adapt(ghost->second.list);
+            m_adapted = true;
+            m_adapted_hash = incoming_hash;
+            in_b2 = ghost->second.list == T2;
+        } else if (m_t1.size() >= m_capacity) {
+            // T1独占整个缓存且B1为空：直接丢弃T1最旧元素，不留幽灵记录
+            m_drop_victim = true;
+            return std::prev(m_t1.end());
+        }
+
+        // REPLACE：T1超过目标值p时从T1淘汰，否则从T2淘汰
+        m_drop_victim = false;
+        if (!m_t1.empty() && ((in_b2 && m_t1.size() == m_p) || m_t1.size() > m_p || m_t2.empty()))
+            return std::prev(m_t1.end());
+        return std::prev(m_t2.end());
+    }
+
+    void evict(Handle h)
+    {
+        ListId list = h->list;
+        if (!m_drop_victim) {
+            // 哈希冲突时先移除旧的幽灵记录，保证一个哈希只对应一条记录
+            auto old = m_ghosts.find(h->hash);
+            if (old != m_ghosts.end()) {
+                ghostList(old->second.list).erase(old->second.pos);
+                m_ghosts.erase(old);
+            }
+
+            std::list<uint64_t>& ghosts = ghostList(list);
+            ghosts.push_front(h->hash);
+            m_ghosts[h->hash] = Ghost{list, ghosts.begin()};
+
+            // 幽灵记录总数不超过容量
+            if (m_b1.size() + m_b2.size() > m_capacity)
+                dropGhost(m_b1.size() > m_b2.size() ? m_b1 : m_b2);
+        }
+        m_drop_victim = false;
+
+        (list == T1 ? m_t1 : m_t2).erase(h);
+    }
+
+    const K& key(Handle h) const { return h->key; }
+
+private:
+    std::list<uint64_t>& ghostList(ListId list) { return list == T1 ? m_b1 : m_b2; }
+
+    void adapt(ListId ghost)
+    {
+        size_t b1 = m_b1.size() ? m_b1.size() : 1;
+        size_t b2 = m_b2.size() ? m_b2.size() : 1;
+        if (ghost == T1)
+            m_p = std::min(m_capacity, m_p + std::max<size_t>(b2 / b1, 1));
+        else
+            m_p -= std::min(m_p, std::max<size_t>(b1 / b2, 1));
+    }
+
+    void dropGhost(std::list<uint64_t>& ghosts)
+    {
+        m_ghosts.erase(ghosts.back());
+        ghosts.pop_back();
+    }
+
+    size_t m_capacity;
+    size_t m_p = 0;                 // T1的目标大小
+    bool m_adapted = false;         // victim()已为m_adapted_hash调整过p
+    uint64_t m_adapted_hash = 0;
+    bool m_drop_victim = false;
+    std::list<Node> m_t1, m_t2;     // 驻留元素，头部最新
+    std::list<uint64_t> m_b1, m_b2; // 幽灵记录，头部最新
+    std::unordered_map<uint64_t, Ghost> m_ghosts;
+};
+
+// 2Q：
+//  - A1in：首次访问的元素进入的FIFO队列（约25%容量），命中不改变位置
+//  - A1out：从A1in淘汰的幽灵记录（只保存哈希值，约50%容量）
+//  - Am：在A1out中再次出现的元素进入的LRU主队列
+template<typename K>
+class TwoQPolicy
+{
+    enum QueueId : uint8_t { A1IN, AM };
+    struct Node {
+        K key;
+        uint64_t hash;
+        QueueId queue;
+        Node(const K& k, uint64_t h, QueueId q) :key(k), hash(h), queue(q) {}
+    };
+
+public:
+    using Handle = typename std::list<Node>::iterator;
+
+    TwoQPolicy(size_t capacity)
+        :m_in_capacity(std::max<size_t>(capacity / 4, 1)),
+         m_out_capacity(std::max<size_t>(capacity / 2, 1)) {}
+
+    Handle insert(const K& key, uint64_t hash)
+    {
+        auto ghost = m_ghosts.find(hash);
+        if (ghost != m_ghosts.end()) {
+            m_a1out.erase(ghost->second);
+            m_ghosts.erase(ghost);
+            m_am.emplace_front(key, hash, AM);
+            return m_am.begin();
+        }
+
+        m_a1in.emplace_front(key, hash, A1IN);
+        return m_a1in.begin();
+    }
+
+    void touch(Handle h)
+    {
+        if (h->queue == AM) m_am.splice(m_am.begin(), m_am, h);
+    }
+
+    Handle victim(uint64_t)
+    {
+        if (m_a1in.size() > m_in_capacity || m_am.empty())
+            return std::prev(m_a1in.end());
+        return std::prev(m_am.end());
+    }
+
+    void evict(Handle h)
+    {
+        if (h->queue == A1IN) {
+            auto old = m_ghosts.find(h->hash);
+            if (old != m_ghosts.end()) {
+                m_a1out.erase(old->second);
+                m_ghosts.erase(old);
+            }
+
+            m_a1out.push_front(h->hash);
+            m_ghosts[h->hash] = m_a1out.begin();
+            if (m_a1out.size() > m_out_capacity) {
+                m_ghosts.erase(m_a1out.back());
+                m_a1out.pop_back();
+            }
+            m_a1in.erase(h);
+        } else {
+            m_am.erase(h);
+        }
+    }
+
+    const K& key(Handle h) const { return h->key; }
+
+private:
+    size_t m_in_capacity;
+    size_t m_out_capacity;
+    std::list<Node> m_a1in;             // FIFO，头部最新
+    std::list<Node> m_am;               // LRU，头部最新
+    std::list<uint64_t> m_a1out;        // 幽灵记录
+    std::unordered_map<uint64_t, std::list<uint64_t>::iterator> m_ghosts;
+};
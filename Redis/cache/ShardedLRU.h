@@ -0,0 +1,96 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <functional>
+#include <optional>
+
+#include "LRU.h"
+
+// 线程安全的分片LRU：按key哈希分散到N个互相独立的LRUCache，每个分片自带锁、链表和哈希表。
+// 不同分片上的操作互不阻塞，淘汰在分片内部进行（近似全局LRU）。
+template<typename K, typename V, typename Hash = std::hash<K>>
+class ShardedLRUCache
+{
+    public:
+        // capacity 为总容量，平均分到各个分片；shards 会向上取整为2的幂，便于用掩码选分片
+        ShardedLRUCache(size_t capacity, size_t shards = 16)
+        {
+            size_t n = 1;
+            while (n < shards) n <<= 1;
+            m_mask = n - 1;
+
+            size_t per_shard = (capacity + n - 1) / n;
+            m_shards.reserve(n);
+            for (size_t i = 0; i < n; ++i)
+                m_shards.emplace_back(new Shard(per_shard));
+        }
+
+        V get(const K& key)
+        {
+            Shard& shard = shard_for(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            return shard.cache.get(key);
+        }
+
+        // 不抛异常的查找：命中时返回值的拷贝（在分片锁内拷贝，返回后不受其他线程修改影响）
+        std::optional<V> find(const K& key)
+        {
+            Shard& shard = shard_for(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (V* value = shard.cache.find(key)) return *value;
+            return std::nullopt;
+        }
+
+        void put(const K& key, const V& value)
+        {
+            Shard& shard = shard_for(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.cache.put(key, value);
+        }
+
+        // 所有分片的元素总数（逐个加锁读取，只是近似快照）
+        size_t size() const
+        {
+            size_t total = 0;
+            for (auto& shard : m_shards) {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                total += shard->cache.size();
+            }
+            return total;
+        }
+
+        // 所有分片的容量之和
+        size_t capacity() const
+        {
+            size_t total = 0;
+            for (auto& shard : m_shards)
+                total += shard->cache.capacity();
+            return total;
+        }
+
+        size_t shard_count() const { return m_shards.size(); }
+
+    private:
+        // 每个分片独占缓存行，避免相邻分片的锁产生伪共享
+        struct alignas(64) Shard {
+            mutable std::mutex mutex;
+            LRUCache<K, V> cache;
+            explicit Shard(size_t capacity) : cache(capacity) {}
+        };
+
+        Shard& shard_for(const K& key)
+        {
+            // 混合高位再取掩码，std::hash对整数是恒等映射，直接取低位会分布不均
+            size_t h = m_hasher(key);
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return *m_shards[h & m_mask];
+        }
+
+        std::vector<std::unique_ptr<Shard>> m_shards;
+        size_t m_mask;
+        Hash m_hasher;
+};
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "SlabLRU.h"
+#include "SharedLRU.h"
+
+using namespace std;
+
+const int WORKERS = 8;
+const size_t SEGMENT_BYTES = 8 << 20;   // 所有worker共用的8MB
+const size_t KEYS = 1000000;
+const size_t ACCESSES = 1000000;        // 每个worker的访问次数
+
+struct Item {
+    uint64_t id;
+    char payload[48];
+};
+
+// 各worker访问同一批热点数据（Zipf分布），随机序列互不相同
+vector<uint64_t> make_trace(int worker)
+{
+    vector<double> weights(KEYS);
+    for (size_t i = 0; i < KEYS; ++i) weights[i] = 1.0 / pow(i + 1, 0.9);
+    discrete_distribution<uint64_t> zipf(weights.begin(), weights.end());
+    mt19937_64 gen(worker);
+
+    vector<uint64_t> trace(ACCESSES);
+    for (auto& key : trace) key = zipf(gen);
+    return trace;
+}
+
+// fork出WORKERS个进程，各自运行run(worker)得到命中率，结果写回一块匿名共享内存，返回平均值
+template<typename F>
+double run_workers(F run)
+{
+    void* addr = mmap(nullptr, sizeof(double) * WORKERS, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    double* results = static_cast<double*>(addr);
+
+    for (int w = 0; w < WORKERS; ++w) {
+        if (fork() == 0) {
+            results[w] = run(w);
+            _exit(0);
+        }
+    }
+    while (wait(nullptr) > 0) {}
+
+    double total = 0;
+    for (int w = 0; w < WORKERS; ++w) total += results[w];
+    munmap(addr, sizeof(double) * WORKERS);
+    return total / WORKERS;
+}
+
+int main()
+{
+    const char* name = "/lru_shared_demo";
+    SharedLRUCache<uint64_t, Item>::remove(name);
+    size_t capacity = SharedLRUCache<uint64_t, Item>(name, SEGMENT_BYTES).capacity();
+    cout << "shared segment: " << (SEGMENT_BYTES >> 20) << " MB, " << capacity << " entries\n";
+
+    // 每个进程一份私有缓存，总内存相同，每份只有1/WORKERS的容量
+    double private_ratio = run_workers([&](int w) {
+        SlabLRUCache<uint64_t, Item> cache(capacity / WORKERS);
+        size_t hits = 0;
+        for (uint64_t key : make_trace(w)) {
+            if (cache.find(key)) ++hits;
+            else cache.put(key, Item{key, {}});
+        }
+        return static_cast<double>(hits) / ACCESSES;
+    });
+
+    // 所有进程共用一份缓存：一个进程回源写入后，其他进程直接命中
+    double shared_ratio = run_workers([&](int w) {
+        SharedLRUCache<uint64_t, Item> cache(name, SEGMENT_BYTES);
+        size_t hits = 0;
+        for (uint64_t key : make_trace(w)) {
+            if (cache.find(key)) ++hits;
+            else cache.put(key, Item{key, {}});
+        }
+        return static_cast<double>(hits) / ACCESSES;
+    });
+
+    cout << "hit ratio, " << WORKERS << " private caches: " << private_ratio << "\n";
+    cout << "hit ratio, one shared cache: " << shared_ratio << "\n";
+
+    SharedLRUCache<uint64_t, Item>::remove(name);
+    return 0;
+}
@@ -0,0 +1,446 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <optional>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+
+// 放在POSIX共享内存里、多个进程共用的LRU，结构与SlabLRUCache相同：
+//  - 固定字节数的共享内存段里依次放：段头、节点slab、开放寻址索引
+//  - 节点之间、索引与节点之间都用32位下标相连，不存指针，各进程映射到不同地址也能使用
+//  - 段头里有一把进程间共享的robust互斥锁；持锁进程崩溃后，下一个加锁的进程会清空缓存重新开始，
+//    而不是在可能改到一半的链表上继续操作
+// K、V必须是平凡可拷贝类型（整数、定长数组、POD结构体），按字节哈希和比较，所以K不能含填充字节。
+// 值按拷贝返回，不返回指向共享内存的指针，其他进程随后的修改不会影响已经取到的值。
+//
+// 初始化之前先在段头登记初始化者的pid；创建者在初始化完成前退出时，挂载的进程等待超时后接管初始化，
+// 而不是永远报告段没有初始化（要求各进程在同一个pid命名空间中）。
+//
+// 用法：每个worker用同样的名字和大小构造，第一个进程负责创建和初始化，其余进程直接挂载：
+//   SharedLRUCache<uint64_t, Item> cache("/app_hot_items", 64 << 20);
+template<typename K, typename V>
+class SharedLRUCache
+{
+    static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>,
+                  "SharedLRUCache stores raw bytes, K and V must be trivially copyable");
+    static_assert(std::has_unique_object_representations_v<K>,
+                  "keys are hashed and compared byte-wise, K must not contain padding");
+
+    public:
+        // name是shm_open的名字（以'/'开头），bytes是整个共享内存段的大小
+        SharedLRUCache(const std::string& name, size_t bytes) : m_name(name)
+        {
+            Layout layout = plan(bytes);
+            if (layout.capacity == 0) throw std::length_error("SharedLRUCache segment too small");
+
+            bool creator = true;
+            int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+            if (fd < 0 && errno == EEXIST) {
+                creator = false;
+                fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+            }
+            if (fd < 0) throw std::runtime_error("shm_open failed: " + name);
+
+            if (creator && ::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+                ::close(fd);
+                ::shm_unlink(name.c_str());
+                throw std::runtime_error("ftruncate failed: " + name);
+            }
+            if (!creator && !waitForSize(fd, bytes)) {
+                // 段一直是空的：创建者在ftruncate之前退出了，替它设置大小，初始化在下面接管
+                struct stat st;
+                if (::fstat(fd, &st) != 0 || st.st_size != 0 || ::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+                    ::close(fd);
+                    throw std::runtime_error("shared cache segment size mismatch: " + name);
+                }
+            }
+
+            void* addr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (addr == MAP_FAILED) throw std::runtime_error("mmap failed: " + name);
+
+            m_base = static_cast<char*>(addr);
+            m_bytes = bytes;
+            m_header = reinterpret_cast<Header*>(m_base);
+            m_nodes = reinterpret_cast<Node*>(m_base + layout.nodes_offset);
+            m_slots = reinterpret_cast<Slot*>(m_base + layout.slots_offset);
+
+            // 创建者也要先登记；已经有进程接管了初始化时按挂载处理
+            if (creator && claim(0)) {
+                initialize(layout);
+            } else {
+                // 构造函数抛出时析构函数不会执行，在这里解除映射
+                try {
+                    waitUntilReady(layout);
+                } catch (...) {
+                    ::munmap(m_base, m_bytes);
+                    throw;
+                }
+                if (m_header->key_size != sizeof(K) || m_header->value_size != sizeof(V) ||
+                    m_header->capacity != layout.capacity) {
+                    ::munmap(m_base, m_bytes);
+                    throw std::runtime_error("shared cache segment layout mismatch: " + name);
+                }
+            }
+        }
+
+        // 只解除映射，不删除共享内存段，其他进程还在使用
+        ~SharedLRUCache() { ::munmap(m_base, m_bytes); }
+
+        SharedLRUCache(const SharedLRUCache&) = delete;
+        SharedLRUCache& operator=(const SharedLRUCache&) = delete;
+
+        // 删除共享内存段，已挂载的进程不受影响，全部解除映射后才真正释放
+        static bool remove(const std::string& name) { return ::shm_unlink(name.c_str()) == 0; }
+
+        V get(const K& key)
+        {
+            std::optional<V> value = find(key);
+            if (!value) throw std::out_of_range("Key not found");
+            return *value;
+        }
+
+        // 不抛异常的查找：命中时返回值的拷贝并更新访问顺序
+        std::optional<V> find(const K& key)
+        {
+            Lock lock(*this);
+            uint32_t hash = hash_of(key);
+            size_t pos = find_slot(key, hash);
+            if (pos == NPOS) return std::nullopt;
+
+            uint32_t idx = m_slots[pos].node;
+            move_to_front(idx); // 将节点移动到链表头部
+            return m_nodes[idx].value;
+        }
+
+        void put(const K& key, const V& value)
+        {
+            Lock lock(*this);
+            Header& h = *m_header;
+            uint32_t hash = hash_of(key);
+            size_t pos = find_slot(key, hash);
+            if (pos != NPOS)
+            {
+                uint32_t idx = m_slots[pos].node;
+                m_nodes[idx].value = value; // 更新值
+                move_to_front(idx);
+                return;
+            }
+
+            // 没有空闲节点时淘汰尾部元素，复用它的节点
+            if (h.free == NIL)
+            {
+                uint32_t victim = h.tail;
+                erase_slot(find_slot(m_nodes[victim].key, hash_of(m_nodes[victim].key)));
+                unlink(victim);
+                m_nodes[victim].next = h.free;
+                h.free = victim;
+                --h.size;
+            }
+
+            uint32_t idx = h.free;
+            h.free = m_nodes[idx].next;
+
+            Node& node = m_nodes[idx];
+            node.key = key;
+            node.value = value;
+            push_front(idx);
+            insert_slot(idx, hash);
+            ++h.size;
+        }
+
+        bool erase(const K& key)
+        {
+            Lock lock(*this);
+            size_t pos = find_slot(key, hash_of(key));
+            if (pos == NPOS) return false;
+
+            uint32_t idx = m_slots[pos].node;
+            erase_slot(pos);
+            unlink(idx);
+            m_nodes[idx].next = m_header->free;
+            m_header->free = idx;
+            --m_header->size;
+            return true;
+        }
+
+        void clear()
+        {
+            Lock lock(*this);
+            reset();
+        }
+
+        size_t size() const
+        {
+            Lock lock(*this);
+            return m_header->size;
+        }
+
+        size_t capacity() const { return m_header->capacity; }
+
+    private:
+        static constexpr uint32_t NIL = UINT32_MAX;
+        static constexpr size_t NPOS = SIZE_MAX;
+        static constexpr uint64_t MAGIC = 0x3155524c4853594cULL;   // "LYSHLRU1"
+        static constexpr uint64_t INITIALIZING = 0x54494e49ULL << 32;  // 高32位"INIT"，低32位是初始化者的pid
+        static constexpr uint64_t PID_MASK = 0xffffffffULL;
+
+        struct Node {
+            K key;
+            V value;
+            uint32_t prev;
+            uint32_t next;
+        };
+
+        struct Slot {
+            uint32_t node;      // NIL表示空槽
+            uint32_t hash;
+        };
+
+        // 段头，放在共享内存段的开头。除ready外的字段都只在持锁时读写
+        struct alignas(64) Header {
+            std::atomic<uint64_t> ready;    // 0：未开始，INITIALIZING | pid：初始化中，MAGIC：初始化完成
+            pthread_mutex_t mutex;
+            uint32_t key_size;
+            uint32_t value_size;
+            uint32_t capacity;
+            uint32_t mask;      // 索引槽位数 - 1
+            uint32_t head;      // 最新
+            uint32_t tail;      // 最旧
+            uint32_t free;      // 空闲节点链表头
+            uint32_t size;
+        };
+
+        struct Layout {
+            size_t capacity = 0;
+            size_t slots = 0;
+            size_t nodes_offset = 0;
+            size_t slots_offset = 0;
+        };
+
+        static size_t align_up(size_t n, size_t a) { return (n + a - 1) / a * a; }
+
+        // 在bytes字节内放下尽量多的节点：索引槽位数取2的幂，负载因子不超过0.5
+        static Layout plan(size_t bytes)
+        {
+            Layout best;
+            size_t nodes_offset = align_up(sizeof(Header), alignof(Node) > 64 ? alignof(Node) : 64);
+            for (size_t slots = 16; slots <= (size_t(1) << 32); slots <<= 1) {
+                size_t slot_bytes = slots * sizeof(Slot);
+                if (nodes_offset + slot_bytes > bytes) break;
+
+                size_t capacity = std::min(slots / 2, (bytes - nodes_offset - slot_bytes) / sizeof(Node));
+                capacity = std::min<size_t>(capacity, NIL - 1);
+                while (capacity > 0 &&
+                       align_up(nodes_offset + capacity * sizeof(Node), alignof(Slot)) + slot_bytes > bytes)
+                    --capacity;
+                if (capacity > best.capacity) {
+                    best.capacity = capacity;
+                    best.slots = slots;
+                    best.nodes_offset = nodes_offset;
+                    best.slots_offset = align_up(nodes_offset + capacity * sizeof(Node), alignof(Slot));
+                }
+            }
+            return best;
+        }
+
+        void initialize(const Layout& layout)
+        {
+            Header& h = *m_header;
+            pthread_mutexattr_t attr;
+            pthread_mutexattr_init(&attr);
+            pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+            pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+            pthread_mutex_init(&h.mutex, &attr);
+            pthread_mutexattr_destroy(&attr);
+
+            h.key_size = sizeof(K);
+            h.value_size = sizeof(V);
+            h.capacity = static_cast<uint32_t>(layout.capacity);
+            h.mask = static_cast<uint32_t>(layout.slots - 1);
+            reset();
+            h.ready.store(MAGIC, std::memory_order_release);
+        }
+
+        // 清空缓存：所有节点放回空闲链表，索引全部置空。调用时持锁（或尚未发布）
+        void reset()
+        {
+            Header& h = *m_header;
+            for (uint32_t i = 0; i < h.capacity; ++i)
+                m_nodes[i].next = (i + 1 < h.capacity) ? i + 1 : NIL;
+            for (size_t i = 0; i <= h.mask; ++i) m_slots[i] = Slot{NIL, 0};
+            h.free = h.capacity ? 0 : NIL;
+            h.head = NIL;
+            h.tail = NIL;
+            h.size = 0;
+        }
+
+        // 等待创建者完成ftruncate
+        static bool waitForSize(int fd, size_t bytes)
+        {
+            for (int i = 0; i < 1000; ++i) {
+                struct stat st;
+                if (::fstat(fd, &st) != 0) return false;
+                if (static_cast<size_t>(st.st_size) == bytes) return true;
+                if (st.st_size != 0) return false;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return false;
+        }
+
+        // 把ready从expected改为 INITIALIZING | 本进程pid，成功的进程负责初始化
+        bool claim(uint64_t expected)
+        {
+            uint64_t mine = INITIALIZING | static_cast<uint32_t>(::getpid());
+            return m_header->ready.compare_exchange_strong(expected, mine, std::memory_order_acq_rel);
+        }
+
+        // 初始化者已经退出，或者一直没有进程登记
+        static bool abandoned(uint64_t state)
+        {
+            if (state == 0) return true;
+            if ((state & ~PID_MASK) != INITIALIZING) return false;
+            pid_t pid = static_cast<pid_t>(state & PID_MASK);
+            return ::kill(pid, 0) != 0 && errno == ESRCH;
+        }
+
+        // 每轮最多等1秒；超时后如果初始化者已经不在，抢到初始化权的进程重新初始化。
+        // 初始化者还活着时继续等待，10轮后仍未完成就放弃
+        void waitUntilReady(const Layout& layout)
+        {
+            for (int round = 0; round < 10; ++round) {
+                for (int i = 0; i < 1000; ++i) {
+                    if (m_header->ready.load(std::memory_order_acquire) == MAGIC) return;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+
+                uint64_t state = m_header->ready.load(std::memory_order_acquire);
+                if (state == MAGIC) return;
+                if (abandoned(state) && claim(state)) {
+                    initialize(layout);
+                    return;
+                }
+            }
+            throw std::runtime_error("shared cache segment was never initialized: " + m_name);
+        }
+
+        class Lock
+        {
+            public:
+                explicit Lock(const SharedLRUCache& cache) : m_mutex(&cache.m_header->mutex)
+                {
+                    int rc = pthread_mutex_lock(m_mutex);
+                    if (rc == EOWNERDEAD) {
+                        // 上一个持锁进程在修改途中退出，链表和索引可能不一致，清空后继续使用
+                        const_cast<SharedLRUCache&>(cache).reset();
+                        pthread_mutex_consistent(m_mutex);
+                    } else if (rc != 0) {
+                        throw std::runtime_error("SharedLRUCache lock failed");
+                    }
+                }
+                ~Lock() { pthread_mutex_unlock(m_mutex); }
+
+            private:
+                pthread_mutex_t* m_mutex;
+        };
+
+        // 按字节哈希，不依赖std::hash的实现，不同程序挂载同一个段也能得到相同结果
+        static uint32_t hash_of(const K& key)
+        {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(&key);
+            uint64_t h = 14695981039346656037ULL;   // FNV-1a
+            for (size_t i = 0; i < sizeof(K); ++i) {
+                h ^= p[i];
+                h *= 1099511628211ULL;
+            }
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return static_cast<uint32_t>(h);
+        }
+
+        static bool key_equal(const K& a, const K& b) { return std::memcmp(&a, &b, sizeof(K)) == 0; }
+
+        size_t find_slot(const K& key, uint32_t hash) const
+        {
+            size_t mask = m_header->mask;
+            for (size_t pos = hash & mask; ; pos = (pos + 1) & mask) {
+                const Slot& slot = m_slots[pos];
+                if (slot.node == NIL) return NPOS;
+                if (slot.hash == hash && key_equal(m_nodes[slot.node].key, key)) return pos;
+            }
+        }
+
+        void insert_slot(uint32_t idx, uint32_t hash)
+        {
+            size_t mask = m_header->mask;
+            size_t pos = hash & mask;
+            while (m_slots[pos].node != NIL) pos = (pos + 1) & mask;
+            m_slots[pos] = Slot{idx, hash};
+        }
+
+        // 线性探测表的删除：把后续元素向前回填，不留墓碑
+        void erase_slot(size_t hole)
+        {
+            size_t mask = m_header->mask;
+            size_t pos = hole;
+            for (;;) {
+                pos = (pos + 1) & mask;
+                if (m_slots[pos].node == NIL) break;
+
+                size_t home = m_slots[pos].hash & mask;
+                if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+                    m_slots[hole] = m_slots[pos];
+                    hole = pos;
+                }
+            }
+            m_slots[hole].node = NIL;
+        }
+
+        void unlink(uint32_t idx)
+        {
+            Node& node = m_nodes[idx];
+            if (node.prev != NIL) m_nodes[node.prev].next = node.next;
+            else m_header->head = node.next;
+            if (node.next != NIL) m_nodes[node.next].prev = node.prev;
+            else m_header->tail = node.prev;
+        }
+
+        void push_front(uint32_t idx)
+        {
+            Node& node = m_nodes[idx];
+            node.prev = NIL;
+            node.next = m_header->head;
+            if (m_header->head != NIL) m_nodes[m_header->head].prev = idx;
+            else m_header->tail = idx;
+            m_header->head = idx;
+        }
+
+        void move_to_front(uint32_t idx)
+        {
+            if (idx == m_header->head) return;
+            unlink(idx);
+            push_front(idx);
+        }
+
+        std::string m_name;
+        char* m_base = nullptr;
+        size_t m_bytes = 0;
+        Header* m_header = nullptr;
+        Node* m_nodes = nullptr;    // 节点slab
+        Slot* m_slots = nullptr;    // 开放寻址索引
+};
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
+
+#include "CacheHash.h"
+
+// 与LRUCache接口相同的另一种存储实现：
+//  - 所有节点预先分配在一块连续的slab数组中，前后指针用32位下标代替
+//  - key索引是一张开放寻址（线性探测）的扁平哈希表，槽位里只存节点下标和哈希值
+// 构造后put/get不再做任何堆分配，查找时只访问一个索引槽位和一个节点。
+// 要求K、V可默认构造；容量上限为 2^32 - 2。
+template<typename K, typename V, typename Hash = std::hash<K>>
+class SlabLRUCache
+{
+    public:
+        SlabLRUCache(size_t capacity) : m_capacity(capacity)
+        {
+            if (capacity >= NIL) throw std::length_error("SlabLRUCache capacity too large");
+
+            m_nodes.resize(capacity);
+            // 空闲节点串成单链表
+            for (size_t i = 0; i < capacity; ++i)
+                m_nodes[i].next = (i + 1 < capacity) ? static_cast<uint32_t>(i + 1) : NIL;
+            m_free = capacity ? 0 : NIL;
+
+            // 索引表大小取2的幂，负载因子不超过0.5，保证探测链足够短
+            size_t slots = 16;
+            while (slots < capacity * 2) slots <<= 1;
+            m_slots.assign(slots, Slot{NIL, 0});
+            m_mask = slots - 1;
+        }
+
+        V get(K key)
+        {
+            V* value = find(key);
+            if (value == nullptr) throw std::out_of_range("Key not found");
+            return *value;
+        }
+
+        // 不抛异常的查找：命中返回值的指针（同时更新访问顺序），未命中返回nullptr。
+        // 指针在该条目被淘汰之前有效。
+        V* find(const K& key)
+        {
+            uint32_t hash = hash_of(key);
+            size_t pos = find_slot(key, hash);
+            if (pos == NPOS) return nullptr;
+
+            uint32_t idx = m_slots[pos].node;
+            move_to_front(idx); // 将节点移动到链表头部
+            return &m_nodes[idx].value;
+        }
+
+        void put(K key, V value)
+        {
+            uint32_t hash = hash_of(key);
+            size_t pos = find_slot(key, hash);
+            if (pos != NPOS)
+            {
+                uint32_t idx = m_slots[pos].node;
+                m_nodes[idx].value = value; // 更新值
+                move_to_front(idx);
+                return;
+            }
+
+            if (m_capacity == 0) return;
+
+            // 没有空闲节点时淘汰尾部元素，复用它的节点
+            if (m_free == NIL)
+            {
+                uint32_t victim = m_tail;
+                erase_slot(find_slot(m_nodes[victim].key, hash_of(m_nodes[victim].key)));
+                unlink(victim);
+                m_nodes[victim].next = m_free;
+                m_free = victim;
+                --m_size;
+            }
+
+            uint32_t idx = m_free;
+            m_free = m_nodes[idx].next;
+
+            Node& node = m_nodes[idx];
+            node.key = key;
+            node.value = value;
+            push_front(idx);
+            insert_slot(idx, hash);
+            ++m_size;
+        }
+
+        // 批量查找：out[i]为keys[i]对应值的指针，未命中为nullptr，返回命中数。
+        // 每组key分几轮：先计算全部哈希并预取索引槽位，再探测索引并预取节点及其前后节点，最后调整访问顺序。
+        size_t get_many(const std::vector<K>& keys, std::vector<V*>& out)
+        {
+            out.assign(keys.size(), nullptr);
+            size_t hits = 0;
+
+            for (size_t begin = 0; begin < keys.size(); begin += BATCH_GROUP) {
+                size_t n = std::min(BATCH_GROUP, keys.size() - begin);
+                const K* group = keys.data() + begin;
+                uint32_t hashes[BATCH_GROUP];
+                size_t positions[BATCH_GROUP];
+
+                for (size_t i = 0; i < n; ++i) {
+                    hashes[i] = hash_of(group[i]);
+                    cache_prefetch(&m_slots[hashes[i] & m_mask]);
+                }
+
+                for (size_t i = 0; i < n; ++i) {
+                    positions[i] = NPOS;
+                    // 只比较哈希值，不访问节点，节点留到下一轮再确认
+                    for (size_t pos = hashes[i] & m_mask; m_slots[pos].node != NIL; pos = (pos + 1) & m_mask) {
+                        if (m_slots[pos].hash == hashes[i]) {
+                            positions[i] = pos;
+                            cache_prefetch(&m_nodes[m_slots[pos].node]);
+                            break;
+                        }
+                    }
+                }
+
+                // 调整访问顺序要改写前后相邻节点，先把它们也预取进来
+                for (size_t i = 0; i < n; ++i) {
+                    if (positions[i] == NPOS) continue;
+                    const Node& node = m_nodes[m_slots[positions[i]].node];
+                    if (node.prev != NIL) cache_prefetch(&m_nodes[node.prev]);
+                    if (node.next != NIL) cache_prefetch(&m_nodes[node.next]);
+                }
+
+                for (size_t i = 0; i < n; ++i) {
+                    if (positions[i] == NPOS) continue;
+
+                    // 哈希值相同但key不同时退回完整的探测
+                    size_t pos = positions[i];
+                    if (!(m_nodes[m_slots[pos].node].key == group[i]))
+                        pos = find_slot(group[i], hashes[i]);
+                    if (pos == NPOS) continue;
+
+                    uint32_t idx = m_slots[pos].node;
+                    move_to_front(idx);
+                    out[begin + i] = &m_nodes[idx].value;
+                    ++hits;
+                }
+            }
+            return hits;
+        }
+
+        // 批量写入：先为整批key预取索引槽位，再逐个写入
+        void put_many(const std::vector<std::pair<K, V>>& items)
+        {
+            for (size_t begin = 0; begin < items.size(); begin += BATCH_GROUP) {
+                size_t n = std::min(BATCH_GROUP, items.size() - begin);
+                for (size_t i = 0; i < n; ++i)
+                    cache_prefetch(&m_slots[hash_of(items[begin + i].first) & m_mask]);
+                for (size_t i = 0; i < n; ++i)
+                    put(items[begin + i].first, items[begin + i].second);
+            }
+        }
+
+        size_t size() const { return m_size; }
+        size_t capacity() const { return m_capacity; }
+
+    private:
+        static constexpr uint32_t NIL = UINT32_MAX;
+        static constexpr size_t NPOS = SIZE_MAX;
+        static constexpr size_t BATCH_GROUP = 16;  // 批量接口每组同时在途的key数
+
+        struct Node {
+            K key;
+            V value;
+            uint32_t prev = NIL;
+            uint32_t next = NIL;
+        };
+
+        // 索引槽位：node为NIL表示空槽；hash是key哈希值的低32位，
+        // 既用来快速排除不相等的key，也用来在删除时计算元素的初始位置
+        struct Slot {
+            uint32_t node;
+            uint32_t hash;
+        };
+
+        uint32_t hash_of(const K& key) const
+        {
+            // 对std::hash结果再做一次混合，整数key的std::hash是恒等映射
+            uint64_t h = m_hasher(key);
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return static_cast<uint32_t>(h);
+        }
+
+        size_t find_slot(const K& key, uint32_t hash) const
+        {
+            for (size_t pos = hash & m_mask; ; pos = (pos + 1) & m_mask) {
+                const Slot& slot = m_slots[pos];
+                if (slot.node == NIL) return NPOS;
+                if (slot.hash == hash && m_nodes[slot.node].key == key) return pos;
+            }
+        }
+
+        void insert_slot(uint32_t idx, uint32_t hash)
+        {
+            size_t pos = hash & m_mask;
+            while (m_slots[pos].node != NIL) pos = (pos + 1) & m_mask;
+            m_slots[pos] = Slot{idx, hash};
+        }
+
+        // 线性探测表的删除：把后续元素向前回填，不留墓碑
+        void erase_slot(size_t hole)
+        {
+            size_t pos = hole;
+            for (;;) {
+                pos = (pos + 1) & m_mask;
+                if (m_slots[pos].node == NIL) break;
+
+                size_t home = m_slots[pos].hash & m_mask;
+                if (((pos - home) & m_mask) >= ((pos - hole) & m_mask)) {
+                    m_slots[hole] = m_slots[pos];
+                    hole = pos;
+                }
+            }
+            m_slots[hole].node = NIL;
+        }
+
+        void unlink(uint32_t idx)
+        {
+            Node& node = m_nodes[idx];
+            if (node.prev != NIL) m_nodes[node.prev].next = node.next;
+            else m_head = node.next;
+            if (node.next != NIL) m_nodes[node.next].prev = node.prev;
+            else m_tail = node.prev;
+        }
+
+        void push_front(uint32_t idx)
+        {
+            Node& node = m_nodes[idx];
+            node.prev = NIL;
+            node.next = m_head;
+            if (m_head != NIL) m_nodes[m_head].prev = idx;
+            else m_tail = idx;
+            m_head = idx;
+        }
+
+        void move_to_front(uint32_t idx)
+        {
+            if (idx == m_head) return;
+            unlink(idx);
+            push_front(idx);
+        }
+
+        size_t m_capacity;
+        size_t m_size = 0;
+        size_t m_mask;
+        uint32_t m_head = NIL;      // 最新
+        uint32_t m_tail = NIL;      // 最旧
+        uint32_t m_free;            // 空闲节点链表头
+        std::vector<Node> m_nodes;  // 节点slab
+        std::vector<Slot> m_slots;  // 开放寻址索引
+        Hash m_hasher;
+};
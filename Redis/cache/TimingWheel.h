@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <chrono>
+
+// 分层时间轮：4层，每层64个槽。第l层一个槽跨越 64^l 个tick，
+// 第0层每个tick处理一个槽，高层的槽在低层转满一圈时整体下放（cascade）到低层。
+// 定时器的添加、取消是O(1)。每层用一个64位的位图记录哪些槽非空，推进时间时直接跳到下一个非空槽到期
+// 或下放的tick，中间的空槽不逐个处理，空闲很久之后推进的开销也与经过的时间无关。
+// 定时器节点在各槽之间用splice移动，Handle在定时器触发或取消之前一直有效。
+// T是定时器携带的数据，通常是缓存节点的迭代器，触发时不需要再查哈希表。
+template<typename T>
+class TimingWheel
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Timer {
+        T data;
+        uint64_t expire;    // 到期的tick
+        uint8_t level;      // 所在层
+        uint8_t slot;       // 所在槽
+        Timer(const T& d, uint64_t e) :data(d), expire(e), level(0), slot(0) {}
+    };
+    using Handle = typename std::list<Timer>::iterator;
+
+    TimingWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(1))
+        :m_tick(tick), m_epoch(Clock::now()) {}
+
+    // 把时间点换算成tick
+    uint64_t tick_of(Clock::time_point t) const
+    {
+        if (t <= m_epoch) return 0;
+        return static_cast<uint64_t>((t - m_epoch) / m_tick);
+    }
+
+    uint64_t now() const { return tick_of(Clock::now()); }
+
+    std::chrono::milliseconds tick_duration() const { return m_tick; }
+
+    // 添加一个在expire这个tick到期的定时器
+    Handle schedule(const T& data, uint64_t expire)
+    {
+        std::list<Timer> tmp;
+        tmp.emplace_back(data, expire);
+        Handle h = tmp.begin();
+        place(tmp, h);
+        ++m_count;
+        return h;
+    }
+
+    // 修改定时器的到期时间，节点原地移动
+    void reschedule(Handle h, uint64_t expire)
+    {
+        int level = h->level;
+        int slot = h->slot;
+        h->expire = expire;
+        place(m_slots[level][slot], h);
+        unmark_if_empty(level, slot);
+    }
+
+    void cancel(Handle h)
+    {
+        int level = h->level;
+        int slot = h->slot;
+        m_slots[level][slot].erase(h);
+        unmark_if_empty(level, slot);
+        --m_count;
+    }
+
+    // 推进到now这个tick，对每个到期的定时器调用 on_expire(data)。
+    // 回调返回后定时器节点才被释放，回调中不要再cancel正在触发的定时器。
+    template<typename F>
+    void advance(uint64_t now, F&& on_expire)
+    {
+        while (m_current < now) {
+            // 跳过中间什么都不用做的tick；没有定时器时直接跳到目标时间
+            uint64_t next = next_event();
+            if (next > now) {
+                m_current = now;
+                return;
+            }
+
+            m_current = next;
+            cascade();
+
+            uint64_t index = m_current & SLOT_MASK;
+            std::list<Timer>& slot = m_slots[0][index];
+            if (slot.empty()) continue;
+
+            std::list<Timer> expired;
+            expired.splice(expired.end(), slot);
+            m_occupied[0] &= ~(uint64_t(1) << index);
+            m_count -= expired.size();
+            for (auto& timer : expired) on_expire(timer.data);
+        }
+    }
+
+    size_t size() const { return m_count; }
+
+private:
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr uint64_t SLOTS = 1 << SLOT_BITS;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+
+    // 根据剩余时间选择所在的层和槽，把节点从from移动过去
+    void place(std::list<Timer>& from, Handle h)
+    {
+        // 已经过期的定时器放到下一个tick触发
+        uint64_t expire = h->expire > m_current ? h->expire : m_current + 1;
+        uint64_t delta = expire - m_current;
+
+        int level = 0;
+        while (level < LEVELS - 1 && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) ++level;
+
+        // 超出最高层范围的定时器先放在最高层最远的槽，下放时再重新计算
+        if (delta >= (uint64_t(1) << (SLOT_BITS * LEVELS)))
+            expire = m_current + (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+
+        h->level = static_cast<uint8_t>(level);
+        h->slot = static_cast<uint8_t>((expire >> (SLOT_BITS * level)) & SLOT_MASK);
+        m_slots[level][h->slot].splice(m_slots[level][h->slot].end(), from, h);
+        m_occupied[level] |= uint64_t(1) << h->slot;
+    }
+
+    void unmark_if_empty(int level, int slot)
+    {
+        if (m_slots[level][slot].empty()) m_occupied[level] &= ~(uint64_t(1) << slot);
+    }
+
+    // 下一个需要处理的tick：第0层最近的非空槽到期，或高层最近的非空槽下放，取最早的；没有定时器时返回UINT64_MAX。
+    // 第l层的槽只在 64^l 的整数倍处被访问，从下一个这样的边界开始在位图中循环查找第一个非空槽
+    uint64_t next_event() const
+    {
+        uint64_t next = UINT64_MAX;
+        for (int level = 0; level < LEVELS; ++level) {
+            uint64_t occupied = m_occupied[level];
+            if (occupied == 0) continue;
+
+            int shift = SLOT_BITS * level;
+            uint64_t first = (m_current >> shift) + 1;
+            int start = static_cast<int>(first & SLOT_MASK);
+            uint64_t rotated = start == 0 ? occupied : (occupied >> start) | (occupied << (SLOTS - start));
+            uint64_t tick = (first + __builtin_ctzll(rotated)) << shift;
+            if (tick < next) next = tick;
+        }
+        return next;
+    }
+
+    // 低层转满一圈时，把高层当前槽里的定时器重新分配到低层
+    void cascade()
+    {
+        for (int level = 1; level < LEVELS; ++level) {
+            if (m_current & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) break;
+
+            int index = static_cast<int>((m_current >> (SLOT_BITS * level)) & SLOT_MASK);
+            std::list<Timer>& slot = m_slots[level][index];
+            while (!slot.empty()) place(slot, slot.begin());
+            m_occupied[level] &= ~(uint64_t(1) << index);
+        }
+    }
+
+    std::chrono::milliseconds m_tick;
+    Clock::time_point m_epoch;
+    uint64_t m_current = 0;     // 已经处理到的tick
+    size_t m_count = 0;         // 定时器数量
+    std::list<Timer> m_slots[LEVELS][SLOTS];
+    uint64_t m_occupied[LEVELS] = {};   // 每层哪些槽非空
+};
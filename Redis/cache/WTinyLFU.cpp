@@ -0,0 +1,63 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cmath>
+
+#include "LRU.h"
+#include "LFU.h"
+#include "WTinyLFU.h"
+
+using namespace std;
+
+// 生成Zipf分布的访问序列，每隔一段插入一次大范围的顺序扫描
+vector<int> make_trace(size_t length, size_t keys, double skew)
+{
+    vector<double> weights(keys);
+    for (size_t i = 0; i < keys; ++i) weights[i] = 1.0 / pow(i + 1, skew);
+    discrete_distribution<int> zipf(weights.begin(), weights.end());
+    mt19937 gen(7);
+
+    vector<int> trace;
+    trace.reserve(length);
+    int scan_key = keys;
+    while (trace.size() < length) {
+        for (int i = 0; i < 5000 && trace.size() < length; ++i)
+            trace.push_back(zipf(gen));
+        for (int i = 0; i < 2000 && trace.size() < length; ++i)
+            trace.push_back(scan_key++);     // 一次性key，只访问一次
+    }
+    return trace;
+}
+
+// 读不到就回源写入，返回命中率
+template<typename Cache>
+double hit_ratio(Cache& cache, const vector<int>& trace)
+{
+    size_t hits = 0;
+    for (int key : trace) {
+        try {
+            cache.get(key);
+            ++hits;
+        } catch (out_of_range&) {
+            cache.put(key, key);
+        }
+    }
+    return static_cast<double>(hits) / trace.size();
+}
+
+int main()
+{
+    vector<int> trace = make_trace(500000, 50000, 0.9);
+
+    cout << "capacity, LRU, LFU, W-TinyLFU\n";
+    for (size_t capacity : {500, 1000, 2000, 5000}) {
+        LRUCache<int, int> lru(capacity);
+        LFUCache<int, int> lfu(capacity);
+        WTinyLFUCache<int, int> tiny(capacity);
+
+        cout << capacity << ", " << hit_ratio(lru, trace) << ", "
+             << hit_ratio(lfu, trace) << ", " << hit_ratio(tiny, trace) << "\n";
+    }
+
+    return 0;
+}
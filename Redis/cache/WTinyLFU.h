@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <functional>
+#include <stdexcept>
+
+// 4位计数的Count-Min Sketch，用来估计key的访问频率
+//  - 4行，每行width个计数器，16个计数器打包在一个uint64里，约每个缓存条目2字节
+//  - 累计 sample_size 次计数后所有计数器减半（老化），让历史热点逐渐被遗忘
+class FrequencySketch
+{
+public:
+    FrequencySketch(size_t capacity)
+    {
+        size_t width = 16;
+        while (width < capacity) width <<= 1;
+        m_row_mask = width - 1;
+        m_table.assign(DEPTH * width / 16, 0);
+        m_sample_size = 10 * (capacity ? capacity : 1);
+    }
+
+    // 估计频率，取4行中的最小值
+    uint32_t frequency(uint64_t hash) const
+    {
+        uint32_t freq = 15;
+        for (uint32_t i = 0; i < DEPTH; ++i) {
+            size_t idx = index_of(hash, i);
+            uint32_t c = (m_table[idx >> 4] >> ((idx & 15) << 2)) & 0xF;
+            if (c < freq) freq = c;
+        }
+        return freq;
+    }
+
+    void increment(uint64_t hash)
+    {
+        bool added = false;
+        for (uint32_t i = 0; i < DEPTH; ++i) {
+            size_t idx = index_of(hash, i);
+            uint64_t& word = m_table[idx >> 4];
+            uint32_t shift = (idx & 15) << 2;
+            if (((word >> shift) & 0xF) < 15) {
+                word += uint64_t(1) << shift;
+                added = true;
+            }
+        }
+
+        if (added && ++m_size >= m_sample_size) reset();
+    }
+
+private:
+    static constexpr uint32_t DEPTH = 4;
+
+    // 每一行用不同的种子重新混合哈希值
+    size_t index_of(uint64_t hash, uint32_t row) const
+    {
+        static const uint64_t SEEDS[DEPTH] = {
+            0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+            0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL
+        };
+        uint64_t h = (hash + SEEDS[row]) * SEEDS[row];
+        h ^= h >> 32;
+        return row * (m_row_mask + 1) + (h & m_row_mask);
+    }
+
+    // 老化：所有计数器减半
+    void reset()
+    {
+        for (auto& word : m_table)
+            word = (word >> 1) & 0x7777777777777777ULL;
+        m_size /= 2;
+    }
+
+    std::vector<uint64_t> m_table;
+    size_t m_row_mask;
+    size_t m_size = 0;
+    size_t m_sample_size;
+};
+
+// W-TinyLFU：
+//  - 约1%容量的LRU窗口接收新元素，吸收突发访问
+//  - 其余为分段LRU主区：试用段(probation, 20%) + 保护段(protected, 80%)
+//  - 窗口淘汰出的候选者与试用段尾部的牺牲者比较频率估计值，频率更高者留下
+// 扫描式访问的一次性key很难进入主区，而旧热点会随sketch老化被逐渐淘汰。
+template<typename K, typename V, typename Hash = std::hash<K>>
+class WTinyLFUCache
+{
+public:
+    WTinyLFUCache(size_t capacity) :m_capacity(capacity), m_sketch(capacity)
+    {
+        m_window_capacity = capacity / 100 ? capacity / 100 : 1;
+        if (m_window_capacity > capacity) m_window_capacity = capacity;
+        size_t main_capacity = capacity - m_window_capacity;
+        m_protected_capacity = main_capacity * 8 / 10;
+    }
+
+    V get(K key)
+    {
+        V* value = find(key);
+        if (value == nullptr) throw std::out_of_range("Key not found");
+        return *value;
+    }
+
+    // 不抛异常的查找：命中返回值的指针，未命中返回nullptr；无论是否命中都会计入频率
+    V* find(const K& key)
+    {
+        uint64_t hash = hash_of(key);
+        m_sketch.increment(hash);
+        auto it = m_cache.find(key);
+        if (it == m_cache.end()) {
+            m_last_miss = hash;
+            m_has_last_miss = true;
+            return nullptr;
+        }
+
+        m_has_last_miss = false;
+        onHit(it->second);
+        return &it->second->value;
+    }
+
+    void put(K key, V value)
+    {
+        if (m_capacity == 0) return;
+
+        // 未命中后回填同一个key（读穿）是同一次访问，find已经计过频率
+        uint64_t hash = hash_of(key);
+        if (!m_has_last_miss || m_last_miss != hash) m_sketch.increment(hash);
+        m_has_last_miss = false;
+
+        auto it = m_cache.find(key);
+        if (it != m_cache.end()) {
+            it->second->value = value;
+            onHit(it->second);
+            return;
+        }
+
+        // 新元素先进入窗口
+        m_window.emplace_front(key, value, WINDOW);
+        m_cache[key] = m_window.begin();
+
+        if (m_window.size() > m_window_capacity) evictFromWindow();
+    }
+
+    size_t size() const { return m_cache.size(); }
+    size_t capacity() const { return m_capacity; }
+
+private:
+    enum Segment : uint8_t { WINDOW, PROBATION, PROTECTED };
+
+    struct Node {
+        K key;
+        V value;
+        Segment segment;    // 节点所在分段
+        Node(const K& key, const V& val, Segment s) :key(key), value(val), segment(s) {}
+    };
+    using NodeIter = typename std::list<Node>::iterator;
+
+    uint64_t hash_of(const K& key) const
+    {
+        uint64_t h = m_hasher(key);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    void onHit(NodeIter node)
+    {
+        switch (node->segment) {
+        case WINDOW:
+            m_window.splice(m_window.begin(), m_window, node);
+            break;
+        case PROBATION:
+            // 试用段再次命中，晋升到保护段
+            node->segment = PROTECTED;
+            m_protected.splice(m_protected.begin(), m_probation, node);
+            if (m_protected.size() > m_protected_capacity) {
+                // 保护段溢出，尾部降级回试用段
+                NodeIter demoted = std::prev(m_protected.end());
+                demoted->segment = PROBATION;
+                m_probation.splice(m_probation.begin(), m_protected, demoted);
+            }
+            break;
+        case PROTECTED:
+            m_protected.splice(m_protected.begin(), m_protected, node);
+            break;
+        }
+    }
+
+    // 窗口溢出：尾部候选者进入主区，主区已满时由sketch决定留下谁
+    void evictFromWindow()
+    {
+        NodeIter candidate = std::prev(m_window.end());
+
+        if (m_cache.size() <= m_capacity) {
+            candidate->segment = PROBATION;
+            m_probation.splice(m_probation.begin(), m_window, candidate);
+            return;
+        }
+
+        std::list<Node>& victims = m_probation.empty() ? m_protected : m_probation;
+        if (victims.empty()) {
+            evict(m_window, candidate);
+            return;
+        }
+
+        NodeIter victim = std::prev(victims.end());
+        if (m_sketch.frequency(hash_of(candidate->key)) > m_sketch.frequency(hash_of(victim->key))) {
+            evict(victims, victim);
+            candidate->segment = PROBATION;
+            m_probation.splice(m_probation.begin(), m_window, candidate);
+        } else {
+            evict(m_window, candidate);
+        }
+    }
+
+    void evict(std::list<Node>& segment, NodeIter node)
+    {
+        m_cache.erase(node->key);
+        segment.erase(node);
+    }
+
+    size_t m_capacity;
+    size_t m_window_capacity;
+    size_t m_protected_capacity;
+    FrequencySketch m_sketch;
+    std::list<Node> m_window;       // 窗口LRU，头部最新
+    std::list<Node> m_probation;    // 试用段
+    std::list<Node> m_protected;    // 保护段
+    std::unordered_map<K, NodeIter, Hash> m_cache;
+    Hash m_hasher;
+    uint64_t m_last_miss = 0;       // 最近一次未命中的find的哈希值
+    bool m_has_last_miss = false;
+};
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "LRU.h"
+#include "LFU.h"
+#include "SlabLRU.h"
+
+using namespace std;
+
+const size_t ENTRIES = 2000000;     // 缓存条目数，远大于CPU缓存
+const size_t BATCH = 100;           // 每批key数量
+const size_t BATCHES = 50000;       // 批次数
+
+// 单个get循环与get_many对比，全部命中，返回每个key的纳秒数
+template<typename Cache>
+void run(const string& name)
+{
+    Cache cache(ENTRIES);
+    for (uint64_t i = 0; i < ENTRIES; ++i)
+        cache.put(i, i);
+
+    mt19937_64 gen(1);
+    vector<vector<uint64_t>> batches(BATCHES, vector<uint64_t>(BATCH));
+    for (auto& batch : batches)
+        for (auto& key : batch) key = gen() % ENTRIES;
+
+    uint64_t sink = 0;
+    auto begin = chrono::steady_clock::now();
+    for (auto& batch : batches)
+        for (uint64_t key : batch) sink += cache.get(key);
+    double single_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / (BATCHES * BATCH);
+
+    vector<uint64_t*> out;
+    begin = chrono::steady_clock::now();
+    for (auto& batch : batches) {
+        cache.get_many(batch, out);
+        for (uint64_t* value : out) sink += *value;
+    }
+    double batch_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / (BATCHES * BATCH);
+
+    cout << name << ", " << single_ns << ", " << batch_ns << ", " << single_ns / batch_ns << "x"
+         << (sink == 1 ? " " : "") << "\n";
+}
+
+int main()
+{
+    cout << "cache, get_loop_ns/key, get_many_ns/key, speedup\n";
+    run<LRUCache<uint64_t, uint64_t>>("LRUCache");
+    run<LFUCache<uint64_t, uint64_t>>("LFUCache");
+    run<SlabLRUCache<uint64_t, uint64_t>>("SlabLRUCache");
+
+    return 0;
+}
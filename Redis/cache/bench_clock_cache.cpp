@@ -0,0 +1,75 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <vector>
+#include <atomic>
+
+#include "ShardedLRU.h"
+#include "ClockCache.h"
+
+using namespace std;
+
+const size_t CAPACITY = 1 << 20;            // 缓存容量
+const size_t OPS_PER_THREAD = 1000000;      // 每个线程的操作次数
+const int READ_PERCENT = 98;                // 读操作比例
+
+// 多线程压测，返回每秒操作数
+template<typename Cache>
+double run(Cache& cache, int threads)
+{
+    atomic<bool> start{false};
+    vector<thread> workers;
+
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            mt19937 gen(t + 1);
+            // key范围与容量一致，预热后读全部命中
+            uniform_int_distribution<int> key_dist(0, CAPACITY - 1);
+            uniform_int_distribution<int> op_dist(0, 99);
+
+            while (!start.load(memory_order_acquire)) this_thread::yield();
+
+            long long sink = 0;
+            for (size_t i = 0; i < OPS_PER_THREAD; ++i) {
+                int key = key_dist(gen);
+                if (op_dist(gen) < READ_PERCENT) sink += *cache.find(key);
+                else cache.put(key, key);
+            }
+            if (sink == -1) cout << "";
+        });
+    }
+
+    auto begin = chrono::steady_clock::now();
+    start.store(true, memory_order_release);
+    for (auto& w : workers) w.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    return threads * OPS_PER_THREAD / seconds;
+}
+
+template<typename Cache>
+void prefill(Cache& cache)
+{
+    for (size_t i = 0; i < CAPACITY; ++i)
+        cache.put(i, i);
+}
+
+int main()
+{
+    cout << "threads, sharded_lru_ops/s, clock_ops/s, speedup\n";
+    for (int threads : {1, 2, 4, 8, 16, 32}) {
+        // 分片容量向上取整，这里留出余量保证预热后不会淘汰
+        ShardedLRUCache<int, int> sharded(CAPACITY * 2, 64);
+        ClockCache<int, int> clock(CAPACITY);
+        prefill(sharded);
+        prefill(clock);
+
+        double s = run(sharded, threads);
+        double c = run(clock, threads);
+        cout << threads << ", " << (long long)s << ", " << (long long)c
+             << ", " << c / s << "x\n";
+    }
+
+    return 0;
+}
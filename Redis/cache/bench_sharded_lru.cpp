@@ -0,0 +1,102 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <random>
+#include <vector>
+#include <atomic>
+
+#include "LRU.h"
+#include "ShardedLRU.h"
+
+using namespace std;
+
+const size_t CAPACITY = 1 << 20;            // 缓存容量，两组相同
+const size_t KEYS = CAPACITY / 2;           // key范围：分片按哈希分配，每片只用到约一半容量，分布不均也不会淘汰
+const size_t OPS_PER_THREAD = 1000000;      // 每个线程的操作次数
+const int READ_PERCENT = 80;                // 读操作比例
+
+// 单把全局锁包裹的LRUCache，作为对照组
+class GlobalLockLRU
+{
+    public:
+        GlobalLockLRU(size_t capacity) : m_cache(capacity) {}
+
+        int get(int key)
+        {
+            lock_guard<mutex> lock(m_mutex);
+            return m_cache.get(key);
+        }
+
+        void put(int key, int value)
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_cache.put(key, value);
+        }
+    private:
+        mutex m_mutex;
+        LRUCache<int, int> m_cache;
+};
+
+// 多线程压测，返回每秒操作数
+template<typename Cache>
+double run(Cache& cache, int threads)
+{
+    atomic<bool> start{false};
+    vector<thread> workers;
+
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            mt19937 gen(t + 1);
+            // 预热后get全部命中，避免异常开销干扰结果
+            uniform_int_distribution<int> key_dist(0, KEYS - 1);
+            uniform_int_distribution<int> op_dist(0, 99);
+
+            while (!start.load(memory_order_acquire)) this_thread::yield();
+
+            long long sink = 0;
+            for (size_t i = 0; i < OPS_PER_THREAD; ++i) {
+                int key = key_dist(gen);
+                if (op_dist(gen) < READ_PERCENT) sink += cache.get(key);
+                else cache.put(key, key);
+            }
+            if (sink == -1) cout << "";
+        });
+    }
+
+    auto begin = chrono::steady_clock::now();
+    start.store(true, memory_order_release);
+    for (auto& w : workers) w.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    return threads * OPS_PER_THREAD / seconds;
+}
+
+template<typename Cache>
+void prefill(Cache& cache)
+{
+    for (size_t i = 0; i < KEYS; ++i)
+        cache.put(i, i);
+}
+
+int main()
+{
+    cout << "threads, global_lock_ops/s, sharded_ops/s, speedup\n";
+    for (int threads : {1, 2, 4, 8, 16, 32}) {
+        GlobalLockLRU global(CAPACITY);
+        ShardedLRUCache<int, int> sharded(CAPACITY, 64);
+        prefill(global);
+        prefill(sharded);
+        if (sharded.size() != KEYS) {
+            cerr << "a shard evicted during prefill, lower KEYS\n";
+            return 1;
+        }
+
+        double g = run(global, threads);
+        double s = run(sharded, threads);
+        cout << threads << ", " << (long long)g << ", " << (long long)s
+             << ", " << s / g << "x\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "LRU.h"
+#include "SlabLRU.h"
+
+using namespace std;
+
+// 对同一组随机key分别测试命中读取和带淘汰的写入，返回每次操作的纳秒数
+template<typename Cache>
+void run(const string& name, size_t entries)
+{
+    Cache cache(entries);
+
+    auto begin = chrono::steady_clock::now();
+    for (uint64_t i = 0; i < entries; ++i)
+        cache.put(i, i);
+    double fill_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / entries;
+
+    const size_t ops = 5000000;
+    mt19937_64 gen(42);
+    vector<uint64_t> keys(ops);
+    for (auto& k : keys) k = gen() % entries;
+
+    // 全部命中的随机读
+    uint64_t sink = 0;
+    begin = chrono::steady_clock::now();
+    for (uint64_t k : keys) sink += cache.get(k);
+    double get_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / ops;
+
+    // 全部未命中的写入，每次都会淘汰最旧元素
+    begin = chrono::steady_clock::now();
+    for (size_t i = 0; i < ops; ++i) cache.put(entries + i, i);
+    double evict_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / ops;
+
+    cout << name << ", " << entries << ", " << fill_ns << ", " << get_ns << ", " << evict_ns
+         << (sink == 1 ? " " : "") << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+    vector<size_t> sizes = {1000000, 10000000};
+    if (argc > 1) {
+        sizes.clear();
+        for (int i = 1; i < argc; ++i) sizes.push_back(stoull(argv[i]));
+    }
+
+    cout << "layout, entries, fill_ns/op, get_ns/op, put_evict_ns/op\n";
+    for (size_t n : sizes) {
+        run<LRUCache<uint64_t, uint64_t>>("list+map", n);
+        run<SlabLRUCache<uint64_t, uint64_t>>("slab+open_addressing", n);
+    }
+
+    return 0;
+}
@@ -0,0 +1,339 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <functional>
+#include <unordered_map>
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <new>
+
+#include "LRU.h"
+#include "LFU.h"
+#include "SlabLRU.h"
+#include "ShardedLRU.h"
+#include "ClockCache.h"
+#include "WTinyLFU.h"
+#include "PolicyCache.h"
+
+using namespace std;
+
+// 用访问序列（trace）回放各个缓存策略，输出不同容量下的命中率曲线、吞吐和每次访问的堆分配次数。
+// 每次访问按读穿透处理：命中直接返回，未命中则写入缓存。
+//
+// trace来源：
+//   --trace <file>       文本文件，每行一个key（任意字符串）
+//   --trace-bin <file>   二进制文件，连续的小端uint64 key，没有文件头
+//   --gen zipf|scan|mixed  合成序列，配合 --keys --skew --length --seed
+//   --dump-bin <file>    把读入或生成的trace保存成二进制格式，便于复用
+// 其他参数：
+//   --capacity a,b,c     缓存容量（条目数），默认取不同key数的 0.1% 0.5% 1% 5% 10% 25%
+//   --policy a,b,c       只跑指定策略，默认全部
+//   --warmup N           前N次访问只预热，不计入命中率
+//
+// 示例：
+//   ./cache_sim --gen mixed --keys 100000 --skew 0.9 --length 2000000
+//   ./cache_sim --trace access.log --capacity 1000,10000,100000 --policy lru,arc,wtinylfu
+
+// ---------- 堆分配计数：替换全局operator new ----------
+
+static size_t g_allocs = 0;
+
+void* operator new(size_t size)
+{
+    ++g_allocs;
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    ++g_allocs;
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// ---------- trace ----------
+
+struct Options {
+    string trace_file;
+    string trace_bin;
+    string gen = "mixed";
+    string dump_bin;
+    size_t keys = 100000;
+    double skew = 0.9;
+    size_t length = 2000000;
+    uint64_t seed = 7;
+    size_t warmup = 0;
+    vector<size_t> capacities;
+    vector<string> policies;
+};
+
+// 文本trace：每行一个key，按首次出现的顺序编号成整数，所有策略都用相同的整数key回放
+vector<uint64_t> load_text_trace(const string& path)
+{
+    ifstream in(path);
+    if (!in) throw runtime_error("cannot open " + path);
+
+    unordered_map<string, uint64_t> ids;
+    vector<uint64_t> trace;
+    string line;
+    while (getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        auto it = ids.emplace(line, ids.size()).first;
+        trace.push_back(it->second);
+    }
+    return trace;
+}
+
+vector<uint64_t> load_binary_trace(const string& path)
+{
+    ifstream in(path, ios::binary | ios::ate);
+    if (!in) throw runtime_error("cannot open " + path);
+
+    size_t bytes = static_cast<size_t>(in.tellg());
+    vector<uint64_t> trace(bytes / sizeof(uint64_t));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(trace.data()), trace.size() * sizeof(uint64_t));
+    return trace;
+}
+
+void dump_binary_trace(const string& path, const vector<uint64_t>& trace)
+{
+    ofstream out(path, ios::binary);
+    if (!out) throw runtime_error("cannot open " + path);
+    out.write(reinterpret_cast<const char*>(trace.data()), trace.size() * sizeof(uint64_t));
+}
+
+// 合成trace：
+//  zipf  - Zipf分布，skew越大越集中
+//  scan  - 在keys个key上反复顺序扫描，LRU在容量小于keys时命中率为0
+//  mixed - Zipf访问中周期性插入一段一次性key的顺序扫描
+vector<uint64_t> generate_trace(const Options& opt)
+{
+    mt19937_64 gen(opt.seed);
+    vector<uint64_t> trace;
+    trace.reserve(opt.length);
+
+    if (opt.gen == "scan") {
+        for (size_t i = 0; i < opt.length; ++i) trace.push_back(i % opt.keys);
+        return trace;
+    }
+
+    vector<double> weights(opt.keys);
+    for (size_t i = 0; i < opt.keys; ++i) weights[i] = 1.0 / pow(i + 1, opt.skew);
+    discrete_distribution<uint64_t> zipf(weights.begin(), weights.end());
+
+    if (opt.gen == "zipf") {
+        for (size_t i = 0; i < opt.length; ++i) trace.push_back(zipf(gen));
+        return trace;
+    }
+    if (opt.gen != "mixed") throw runtime_error("unknown generator " + opt.gen);
+
+    uint64_t scan_key = opt.keys;
+    while (trace.size() < opt.length) {
+        for (int i = 0; i < 5000 && trace.size() < opt.length; ++i) trace.push_back(zipf(gen));
+        for (int i = 0; i < 2000 && trace.size() < opt.length; ++i) trace.push_back(scan_key++);
+    }
+    return trace;
+}
+
+// ---------- 回放 ----------
+
+struct Result {
+    double hit_ratio;
+    double mops;            // 每秒百万次访问
+    double allocs_per_op;
+};
+
+template<typename Cache, typename = void>
+struct has_find : false_type {};
+
+template<typename Cache>
+struct has_find<Cache, void_t<decltype(declval<Cache&>().find(declval<const uint64_t&>()))>> : true_type {};
+
+// 用find()判断命中；只有get()的缓存靠异常判断未命中，这时未命中的开销和分配次数会偏高
+template<typename Cache>
+bool access(Cache& cache, uint64_t key)
+{
+    if constexpr (has_find<Cache>::value) {
+        if (cache.find(key)) return true;
+    } else {
+        try {
+            cache.get(key);
+            return true;
+        } catch (out_of_range&) {
+        }
+    }
+    cache.put(key, key);
+    return false;
+}
+
+template<typename Cache>
+Result replay(size_t capacity, const vector<uint64_t>& trace, size_t warmup)
+{
+    Cache cache(capacity);
+    warmup = min(warmup, trace.size());
+    for (size_t i = 0; i < warmup; ++i) access(cache, trace[i]);
+
+    size_t hits = 0;
+    size_t allocs = g_allocs;
+    auto begin = chrono::steady_clock::now();
+    for (size_t i = warmup; i < trace.size(); ++i) hits += access(cache, trace[i]);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    allocs = g_allocs - allocs;
+
+    size_t ops = trace.size() - warmup;
+    if (ops == 0) return {0, 0, 0};
+    return {static_cast<double>(hits) / ops, ops / seconds / 1e6, static_cast<double>(allocs) / ops};
+}
+
+// 分片数取不超过16、且整除capacity的最大2的幂，各分片容量之和正好是capacity，
+// 与其他策略比较同样大小的缓存（默认16个分片时每片向上取整，容量1会变成16）
+template<typename K, typename V>
+struct SimShardedLRUCache : ShardedLRUCache<K, V>
+{
+    explicit SimShardedLRUCache(size_t capacity) : ShardedLRUCache<K, V>(capacity, shards_for(capacity)) {}
+
+    static size_t shards_for(size_t capacity)
+    {
+        size_t n = 16;
+        while (n > 1 && capacity % n != 0) n >>= 1;
+        return n;
+    }
+};
+
+using Runner = function<Result(size_t, const vector<uint64_t>&, size_t)>;
+
+const vector<pair<string, Runner>>& all_policies()
+{
+    using K = uint64_t;
+    static const vector<pair<string, Runner>> policies = {
+        {"lru",        replay<LRUCache<K, K>>},
+        {"lfu",        replay<LFUCache<K, K>>},
+        {"slab_lru",   replay<SlabLRUCache<K, K>>},
+        {"sharded_lru", replay<SimShardedLRUCache<K, K>>},
+        {"clock",      replay<ClockCache<K, K>>},
+        {"wtinylfu",   replay<WTinyLFUCache<K, K>>},
+        {"policy_lru", replay<PolicyCache<K, K, LRUPolicy>>},
+        {"policy_lfu", replay<PolicyCache<K, K, LFUPolicy>>},
+        {"arc",        replay<PolicyCache<K, K, ARCPolicy>>},
+        {"2q",         replay<PolicyCache<K, K, TwoQPolicy>>},
+        {"redis_lfu",  replay<PolicyCache<K, K, RedisLFUPolicy>>},
+    };
+    return policies;
+}
+
+// ---------- 命令行 ----------
+
+vector<string> split(const string& s)
+{
+    vector<string> parts;
+    stringstream ss(s);
+    string part;
+    while (getline(ss, part, ',')) if (!part.empty()) parts.push_back(part);
+    return parts;
+}
+
+Options parse(int argc, char* argv[])
+{
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (i + 1 >= argc) throw runtime_error("missing value for " + arg);
+        string value = argv[++i];
+
+        if (arg == "--trace") opt.trace_file = value;
+        else if (arg == "--trace-bin") opt.trace_bin = value;
+        else if (arg == "--gen") opt.gen = value;
+        else if (arg == "--dump-bin") opt.dump_bin = value;
+        else if (arg == "--keys") {
+            opt.keys = stoull(value);
+            if (opt.keys == 0) throw runtime_error("--keys must be positive");
+        }
+        else if (arg == "--skew") opt.skew = stod(value);
+        else if (arg == "--length") opt.length = stoull(value);
+        else if (arg == "--seed") opt.seed = stoull(value);
+        else if (arg == "--warmup") opt.warmup = stoull(value);
+        else if (arg == "--capacity") for (auto& c : split(value)) opt.capacities.push_back(stoull(c));
+        else if (arg == "--policy") opt.policies = split(value);
+        else throw runtime_error("unknown option " + arg);
+    }
+    return opt;
+}
+
+size_t distinct_keys(const vector<uint64_t>& trace)
+{
+    unordered_map<uint64_t, bool> seen;
+    for (uint64_t key : trace) seen[key] = true;
+    return seen.size();
+}
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    vector<uint64_t> trace;
+    try {
+        opt = parse(argc, argv);
+        if (!opt.trace_file.empty()) trace = load_text_trace(opt.trace_file);
+        else if (!opt.trace_bin.empty()) trace = load_binary_trace(opt.trace_bin);
+        else trace = generate_trace(opt);
+        if (!opt.dump_bin.empty()) dump_binary_trace(opt.dump_bin, trace);
+    } catch (exception& e) {
+        cerr << "error: " << e.what() << endl;
+        return 1;
+    }
+
+    size_t distinct = distinct_keys(trace);
+    if (opt.capacities.empty()) {
+        for (double ratio : {0.001, 0.005, 0.01, 0.05, 0.1, 0.25})
+            opt.capacities.push_back(max<size_t>(1, static_cast<size_t>(distinct * ratio)));
+    }
+
+    vector<pair<string, Runner>> selected;
+    for (auto& policy : all_policies()) {
+        if (opt.policies.empty() || find(opt.policies.begin(), opt.policies.end(), policy.first) != opt.policies.end())
+            selected.push_back(policy);
+    }
+    if (selected.empty()) {
+        cerr << "error: no matching policy" << endl;
+        return 1;
+    }
+
+    cout << "trace: " << trace.size() << " accesses, " << distinct << " distinct keys, warmup " << opt.warmup << "\n";
+
+    // results[c][p]
+    vector<vector<Result>> results(opt.capacities.size());
+    for (size_t c = 0; c < opt.capacities.size(); ++c)
+        for (auto& policy : selected)
+            results[c].push_back(policy.second(opt.capacities[c], trace, opt.warmup));
+
+    auto table = [&](const string& title, auto field) {
+        cout << "\n# " << title << "\ncapacity";
+        for (auto& policy : selected) cout << ", " << policy.first;
+        cout << "\n";
+        for (size_t c = 0; c < opt.capacities.size(); ++c) {
+            cout << opt.capacities[c];
+            for (auto& r : results[c]) cout << ", " << field(r);
+            cout << "\n";
+        }
+    };
+
+    table("hit ratio", [](const Result& r) { return r.hit_ratio; });
+    table("throughput (Mops/s)", [](const Result& r) { return r.mops; });
+    table("heap allocations per access", [](const Result& r) { return r.allocs_per_op; });
+
+    return 0;
+}